@@ -0,0 +1,134 @@
+#ifndef __AlignedSoAAllocator_h
+#define __AlignedSoAAllocator_h
+
+// OVERVIEW: AlignedSoAAllocator.h
+// ========
+// Class definition for cache-line-aligned SoA allocator.
+//
+// Last revision: 17/10/2026
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif // __linux__
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// AlignedSoAAllocator: SoA allocator of aligned, padded columns
+// ===================
+// Columns start on a cache line and are padded to a whole number of
+// cache lines with value-initialized elements, so vector loops can
+// run over the padding instead of handling a scalar tail, and columns
+// do not share cache lines. The allocator also provides blocks, from
+// which an SoA carves all its columns at once (see SoA). If hugePages
+// is true, columns and blocks of at least hugePageSize bytes are
+// aligned to huge pages and, on Linux, advised to be backed by them
+// (transparent huge pages).
+//
+template <bool hugePages = false>
+struct AlignedSoAAllocator
+{
+  static constexpr size_t alignment = 64;
+  static constexpr size_t hugePageSize = size_t(2) << 20;
+
+  // Number of elements of a column of count elements, padding included
+  template <typename T>
+  static constexpr size_t paddedCount(size_t count)
+  {
+    return (count * sizeof(T) + alignment - 1) / alignment * alignment /
+      sizeof(T);
+  }
+
+  template <typename T>
+  static T* allocate(size_t count)
+  {
+    if (count == 0)
+      return nullptr;
+
+    auto n = paddedCount<T>(count);
+    auto data = static_cast<T*>(allocateBytes(n * sizeof(T), n));
+
+    std::uninitialized_default_construct_n(data, count);
+    std::uninitialized_value_construct_n(data + count, n - count);
+    return data;
+  }
+
+  template <typename T>
+  static void free(T* ptr)
+  {
+    if (ptr == nullptr)
+      return;
+    std::destroy_n(ptr, header(ptr)->count);
+    freeBytes(ptr);
+  }
+
+  // Block of size bytes into which an SoA carves all its columns
+  static void* allocateBlock(size_t size)
+  {
+    return size == 0 ? nullptr : allocateBytes(size, size);
+  }
+
+  static void freeBlock(void* block)
+  {
+    if (block != nullptr)
+      freeBytes(block);
+  }
+
+private:
+  // Kept in the cache line before the data
+  struct Header
+  {
+    size_t count;
+    size_t alignment;
+
+  }; // Header
+
+  static constexpr size_t headerSize = alignment;
+
+  static_assert(sizeof(Header) <= headerSize);
+
+  static Header* header(void* data)
+  {
+    return reinterpret_cast<Header*>(static_cast<char*>(data) - headerSize);
+  }
+
+  static void* allocateBytes(size_t size, size_t count)
+  {
+    auto align = alignment;
+
+    size += headerSize;
+    if (hugePages && size >= hugePageSize)
+    {
+      align = hugePageSize;
+      size = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+    }
+
+    auto block = static_cast<char*>(::operator new(size, std::align_val_t{align}));
+
+#ifdef __linux__
+    if (align == hugePageSize)
+      madvise(block, size, MADV_HUGEPAGE);
+#endif // __linux__
+    new (block) Header{count, align};
+    return block + headerSize;
+  }
+
+  static void freeBytes(void* data)
+  {
+    auto h = header(data);
+
+    ::operator delete(static_cast<void*>(h), std::align_val_t{h->alignment});
+  }
+
+}; // AlignedSoAAllocator
+
+} // end namespace tcii::cg
+
+#endif // __AlignedSoAAllocator_h
@@ -0,0 +1,33 @@
+#ifndef __AmbientOcclusion_h
+#define __AmbientOcclusion_h
+
+// OVERVIEW: AmbientOcclusion.h
+// ========
+// Function declaration for per-triangle ambient occlusion.
+//
+// Last revision: 17/10/2026
+
+#include "BVH.h"
+#include <cstdint>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+//
+// Sets occlusion[t] to the fraction of rayCount cosine-distributed rays,
+// cast from random points of triangle t of the mesh of bvh over the
+// hemisphere of its normal, that hit the mesh within maxDistance.
+// Triangles are processed in tiles by all threads. Every triangle has
+// its own random sequence, seeded by seed and the triangle index, so
+// the result does not depend on the number of threads. Returns the
+// number of rays cast.
+//
+size_t ambientOcclusion(const BVH& bvh,
+  unsigned rayCount,
+  float* occlusion,
+  float maxDistance = BVH::infinity,
+  uint64_t seed = 0);
+
+} // end namespace tcii::cg
+
+#endif // __AmbientOcclusion_h
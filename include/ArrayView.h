@@ -42,6 +42,16 @@ public:
     return !_data;
   }
 
+  auto begin() const
+  {
+    return _data;
+  }
+
+  auto end() const
+  {
+    return _data + _size;
+  }
+
 private:
   const T* _data{};
   size_t _size{};
@@ -0,0 +1,152 @@
+#ifndef __BVH_h
+#define __BVH_h
+
+// OVERVIEW: BVH.h
+// ========
+// Class definition for bounding volume hierarchy.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// BVH: bounding volume hierarchy of the triangles of a mesh
+// ===
+// Built top-down with binned SAH; the upper levels are split serially
+// and the subtrees below them are built in parallel. Nodes are stored
+// depth-first in a flat array and the two children of an interior node
+// are adjacent. The BVH keeps a copy of the triangle vertices in leaf
+// order, so it is a snapshot of the mesh: rebuild it after changing the
+// vertices or the triangles.
+//
+class BVH: public SharedObject
+{
+public:
+  using index_t = TriangleMesh::index_t;
+  using vec3 = TriangleMesh::vec3;
+  using Bounds = TriangleMesh::Bounds;
+
+  static constexpr auto infinity = std::numeric_limits<float>::infinity();
+  static constexpr auto noTriangle = ~index_t{};
+  static constexpr unsigned packetSize = 8;
+
+  struct Ray
+  {
+    vec3 origin;
+    vec3 direction;
+    float tMin{0};
+    float tMax{infinity};
+
+  }; // Ray
+
+  // Mesh triangle, ray parameter and barycentric coordinates of a hit
+  struct Hit
+  {
+    index_t triangle{noTriangle};
+    float t;
+    float u;
+    float v;
+
+  }; // Hit
+
+  struct Node
+  {
+    vec3 min;
+    // First child if interior, first triangle if leaf
+    index_t offset;
+    vec3 max;
+    // Number of triangles, 0 if interior
+    uint16_t count;
+    // Split axis of an interior node
+    uint16_t axis;
+
+    bool isLeaf() const
+    {
+      return count != 0;
+    }
+
+  }; // Node
+
+  static_assert(sizeof(Node) == 32);
+
+  static ObjectPtr<BVH> New(const TriangleMesh& mesh)
+  {
+    return new BVH{mesh};
+  }
+
+  auto& mesh() const
+  {
+    return *_mesh;
+  }
+
+  auto nodeCount() const
+  {
+    return (index_t)_nodes.size();
+  }
+
+  auto& node(index_t i) const
+  {
+    assert(i < nodeCount());
+    return _nodes[i];
+  }
+
+  auto& bounds() const
+  {
+    return _bounds;
+  }
+
+  // Closest hit in (ray.tMin, ray.tMax)
+  bool intersect(const Ray& ray, Hit& hit) const;
+
+  // Any hit in (ray.tMin, ray.tMax)
+  bool occluded(const Ray& ray) const;
+
+  // Appends the triangles whose bounds overlap box
+  void overlap(const Bounds& box, std::vector<index_t>& triangles) const;
+
+  // Ray batches are traced in packets of packetSize rays sharing the
+  // node fetches; box tests are done for all rays of a packet at once.
+  // Misses are reported with hit.triangle set to noTriangle
+  void intersect(const Ray* rays, Hit* hits, size_t count) const;
+  void occluded(const Ray* rays, bool* results, size_t count) const;
+
+private:
+  // Triangle as a vertex and two edges, in leaf order
+  struct Triangle
+  {
+    vec3 v0;
+    vec3 e1;
+    vec3 e2;
+
+  }; // Triangle
+
+  ObjectPtr<TriangleMesh> _mesh;
+  std::vector<Node> _nodes;
+  std::vector<Triangle> _triangles;
+  std::vector<index_t> _indices;
+  Bounds _bounds;
+
+  BVH(const TriangleMesh& mesh);
+
+  template <bool anyHit>
+  bool trace(const Ray& ray, Hit* hit) const;
+
+  template <bool anyHit>
+  void tracePacket(const Ray* rays,
+    unsigned count,
+    Hit* hits,
+    bool* results) const;
+
+}; // BVH
+
+} // end namespace tcii::cg
+
+#endif // __BVH_h
@@ -0,0 +1,45 @@
+#ifndef __Components_h
+#define __Components_h
+
+// OVERVIEW: Components.h
+// ========
+// Function declaration for connected component labelling.
+//
+// Last revision: 17/10/2026
+
+#include "MeshAttribute.h"
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+struct MeshComponents
+{
+  using Labels = MeshAttribute<void, ElementAttribute<unsigned>>;
+
+  // Component of each triangle
+  ObjectPtr<Labels> labels;
+  // Number of triangles and bounds of each component
+  std::vector<TriangleMesh::index_t> triangleCounts;
+  std::vector<TriangleMesh::Bounds> bounds;
+
+  auto count() const
+  {
+    return unsigned(triangleCounts.size());
+  }
+
+}; // MeshComponents
+
+//
+// Labels the triangles of the mesh with the connected component they
+// belong to; triangles sharing a vertex are connected, so the mesh
+// should be welded first. Vertices are joined by a lock-free union-find
+// in which every root is the least vertex of its set, so components
+// are numbered in the order of their least vertex, whatever the number
+// of threads. Triangles are processed in blocks by all threads.
+//
+MeshComponents connectedComponents(const TriangleMesh& mesh);
+
+} // end namespace tcii::cg
+
+#endif // __Components_h
@@ -8,6 +8,7 @@
 #define __DefaultSoAAllocator_h
 
 #include <cstddef>
+#include <new>
 
 struct DefaultSoAAllocator 
 {
@@ -28,6 +29,22 @@ struct DefaultSoAAllocator
         delete[] ptr;
     }
 
+    static constexpr size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static void* allocateBlock(size_t size)
+    {
+
+        if (size == 0)
+            return nullptr;
+
+        return ::operator new(size);
+    }
+
+    static void freeBlock(void* block)
+    {
+        ::operator delete(block);
+    }
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef __Lighting_h
+#define __Lighting_h
+
+// OVERVIEW: Lighting.h
+// ========
+// Function declarations for per-triangle lighting.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+struct DirectionalLight
+{
+  // Direction towards the light (need not be normalized)
+  Vec3f direction;
+  float intensity{1};
+
+}; // DirectionalLight
+
+//
+// Sets brightness[t] to the sum, over the lights, of intensity *
+// max(0, n . l), where n is the normal of triangle t interpolated from
+// the vertex normals of the mesh at its centroid. Triangles are split
+// into blocks processed by all threads with the vector kernel, which
+// loads the vertex normals of a batch of triangles once for all lights.
+//
+void lambert(const TriangleMesh& mesh,
+  const DirectionalLight* lights,
+  size_t lightCount,
+  float* brightness);
+
+} // end namespace tcii::cg
+
+#endif // __Lighting_h
@@ -7,23 +7,30 @@
 #ifndef __MeshAttribute_h
 #define __MeshAttribute_h
 
+#include "OBJStream.h"
 #include "TriangleMesh.h"
 #include "util/SharedObject.h"
 #include "util/SoA.h"
-#include "DefaultSoAAllocator.h"
+#include "AlignedSoAAllocator.h"
+#include <vector>
 
 namespace tcii::cg {
 
     using MeshIndex = typename TriangleMesh::index_t;
 
+    template <typename Allocator, typename... Fields>
+    using BasicElementAttribute = SoA<Allocator, MeshIndex, Fields...>;
+
+    // Columns aligned to and padded to cache lines (see AlignedSoAAllocator),
+    // so parallel loops over attributes never share cache lines
     template <typename... Fields>
-    using ElementAttribute = SoA<DefaultSoAAllocator, MeshIndex, Fields...>;
+    using ElementAttribute = BasicElementAttribute<AlignedSoAAllocator<>, Fields...>;
 
     template <typename T>
     struct is_element_attribute : std::false_type {};
 
-    template <typename... Fields>
-    struct is_element_attribute<SoA<DefaultSoAAllocator, MeshIndex, Fields...>> : std::true_type {};
+    template <typename Allocator, typename... Fields>
+    struct is_element_attribute<SoA<Allocator, MeshIndex, Fields...>> : std::true_type {};
 
     template <typename T>
     inline constexpr bool is_element_attribute_v = is_element_attribute<T>::value;
@@ -36,7 +43,7 @@ namespace tcii::cg {
 
     template <typename VA, typename TA>
         requires Defined<VA> && Defined<TA>
-    class MeshAttribute<VA, TA> : public SharedObject {
+    class MeshAttribute<VA, TA> : public SharedObject, private TriangleMesh::Observer {
         
         public:
 
@@ -54,6 +61,27 @@ namespace tcii::cg {
             void setVertexAttributes(MeshIndex i, Fields&&... fields) { 
                 _va.set(i, std::forward<Fields>(fields)...); 
             }
+
+            template<size_t I>
+            auto vertexAttributeData() {
+                return _va.template data<I>();
+            }
+
+            auto& vertexAttributes() {
+                return _va;
+            }
+
+            auto& vertexAttributes() const {
+                return _va;
+            }
+
+            auto vertexAttributeTuple(MeshIndex i) const {
+                return _va.tuple(i);
+            }
+
+            void setVertexAttributeTuple(MeshIndex i, const typename VA::tuple_type& t) {
+                _va.setTuple(i, t);
+            }
             
             template<size_t I> 
             auto& triangleAttribute(MeshIndex i) const { 
@@ -70,6 +98,19 @@ namespace tcii::cg {
                 _ta.set(i, std::forward<Fields>(fields)...); 
             }
 
+            template<size_t I>
+            auto triangleAttributeData() {
+                return _ta.template data<I>();
+            }
+
+            auto& triangleAttributes() {
+                return _ta;
+            }
+
+            auto& triangleAttributes() const {
+                return _ta;
+            }
+
             auto& mesh() const {
                 return *_mesh;
             }
@@ -85,16 +126,25 @@ namespace tcii::cg {
             TA _ta;
 
             MeshAttribute(const TriangleMesh& mesh) : 
+            Observer{ mesh },
             _mesh{ &mesh }, 
             _va{ mesh.data().vertexCount() }, 
             _ta{ mesh.data().triangleCount() } 
             {}
+
+            void verticesReordered(const MeshIndex* order) override {
+                _va.permute(order);
+            }
+
+            void trianglesReordered(const MeshIndex* order) override {
+                _ta.permute(order);
+            }
     
     };
 
     template <typename VA, typename TA>
         requires std::is_void_v<VA> && Defined<TA>
-    class MeshAttribute<VA, TA> : public SharedObject {
+    class MeshAttribute<VA, TA> : public SharedObject, private TriangleMesh::Observer {
     
         public:
 
@@ -113,6 +163,19 @@ namespace tcii::cg {
                 _ta.set(i, std::forward<Fields>(fields)...); 
             }
 
+            template<size_t I>
+            auto triangleAttributeData() {
+                return _ta.template data<I>();
+            }
+
+            auto& triangleAttributes() {
+                return _ta;
+            }
+
+            auto& triangleAttributes() const {
+                return _ta;
+            }
+
             auto& mesh() const {
                 return *_mesh;
             }
@@ -127,15 +190,20 @@ namespace tcii::cg {
             TA _ta;
 
             MeshAttribute(const TriangleMesh& mesh) : 
+            Observer{ mesh },
             _mesh{ &mesh }, 
             _ta{ mesh.data().triangleCount() } 
             {}
+
+            void trianglesReordered(const MeshIndex* order) override {
+                _ta.permute(order);
+            }
     
         };
 
     template <typename VA, typename TA> 
         requires Defined<VA> && std::is_void_v<TA>
-    class MeshAttribute<VA, TA> : public SharedObject {
+    class MeshAttribute<VA, TA> : public SharedObject, private TriangleMesh::Observer {
         
         public:
 
@@ -154,6 +222,27 @@ namespace tcii::cg {
                 _va.set(i, std::forward<Fields>(fields)...); 
             }
 
+            template<size_t I>
+            auto vertexAttributeData() {
+                return _va.template data<I>();
+            }
+
+            auto& vertexAttributes() {
+                return _va;
+            }
+
+            auto& vertexAttributes() const {
+                return _va;
+            }
+
+            auto vertexAttributeTuple(MeshIndex i) const {
+                return _va.tuple(i);
+            }
+
+            void setVertexAttributeTuple(MeshIndex i, const typename VA::tuple_type& t) {
+                _va.setTuple(i, t);
+            }
+
             auto& mesh() const {
                 return *_mesh;
             }
@@ -168,10 +257,15 @@ namespace tcii::cg {
             VA _va;
 
             MeshAttribute(const TriangleMesh& mesh) :
+            Observer{ mesh },
             _mesh{ &mesh }, 
             _va{ mesh.data().vertexCount() } 
             {}
 
+            void verticesReordered(const MeshIndex* order) override {
+                _va.permute(order);
+            }
+
     };
 
     template <typename VA, typename TA>
@@ -198,6 +292,127 @@ namespace tcii::cg {
 
     };
 
+    // Vertex attributes of a simplified mesh, where vertex i takes the
+    // attributes of vertex vertexMap[i] of the mesh of source
+    template <typename VA, typename TA>
+        requires Defined<VA>
+    auto transferVertexAttributes(const MeshAttribute<VA, TA>& source, const TriangleMesh& mesh, const std::vector<MeshIndex>& vertexMap) {
+
+        auto ma = MeshAttribute<VA, void>::New(mesh);
+
+        auto nv = mesh.data().vertexCount();
+
+        assert(vertexMap.size() == nv);
+        for (MeshIndex i = 0; i < nv; ++i)
+            ma->setVertexAttributeTuple(i, source.vertexAttributeTuple(vertexMap[i]));
+
+        return ma;
+
+    }
+
+    // Stand-in for the attributes of an element type a batch has none of
+    struct NoAttribute {
+        NoAttribute(MeshIndex) {}
+    };
+
+    // Attributes of the elements of one batch of an OBJStream, so stages
+    // can process a mesh too large to be read at once a batch at a time.
+    // Element i of the vertex (triangle) attributes belongs to vertex
+    // vertexBase() + i (triangle triangleBase() + i) of the file. VA or TA
+    // may be void, as in MeshAttribute
+    template <typename VA, typename TA>
+        requires (Defined<VA> || std::is_void_v<VA>) && (Defined<TA> || std::is_void_v<TA>)
+    class BatchAttribute : public SharedObject {
+
+        public:
+
+            template<size_t I>
+            auto& vertexAttribute(MeshIndex i) const requires Defined<VA> {
+                return _va.template get<I>(i);
+            }
+
+            template<size_t I, typename Field>
+            void setVertexAttribute(MeshIndex i, Field&& field) requires Defined<VA> {
+                _va.template get<I>(i) = std::forward<Field>(field);
+            }
+
+            template <typename... Fields>
+            void setVertexAttributes(MeshIndex i, Fields&&... fields) requires Defined<VA> {
+                _va.set(i, std::forward<Fields>(fields)...);
+            }
+
+            auto& vertexAttributes() requires Defined<VA> {
+                return _va;
+            }
+
+            auto& vertexAttributes() const requires Defined<VA> {
+                return _va;
+            }
+
+            template<size_t I>
+            auto& triangleAttribute(MeshIndex i) const requires Defined<TA> {
+                return _ta.template get<I>(i);
+            }
+
+            template<size_t I, typename Field>
+            void setTriangleAttribute(MeshIndex i, Field&& field) requires Defined<TA> {
+                _ta.template get<I>(i) = std::forward<Field>(field);
+            }
+
+            template <typename... Fields>
+            void setTriangleAttributes(MeshIndex i, Fields&&... fields) requires Defined<TA> {
+                _ta.set(i, std::forward<Fields>(fields)...);
+            }
+
+            auto& triangleAttributes() requires Defined<TA> {
+                return _ta;
+            }
+
+            auto& triangleAttributes() const requires Defined<TA> {
+                return _ta;
+            }
+
+            // Position of vertex i and triangle i of the batch; the vertex
+            // indices of a triangle refer to the whole file
+            auto vertex(MeshIndex i) const {
+                return _batch.vertices[i];
+            }
+
+            auto& triangle(MeshIndex i) const {
+                return _batch.triangles[i];
+            }
+
+            auto vertexBase() const {
+                return _batch.vertexBase;
+            }
+
+            auto triangleBase() const {
+                return _batch.triangleBase;
+            }
+
+            // The arrays of the batch are only valid until the stream
+            // reads the next one, and so are vertex() and triangle()
+            static ObjectPtr<BatchAttribute> New(const OBJStream::Batch& batch) {
+                return new BatchAttribute(batch);
+            }
+
+        private:
+
+            using VS = std::conditional_t<std::is_void_v<VA>, NoAttribute, VA>;
+            using TS = std::conditional_t<std::is_void_v<TA>, NoAttribute, TA>;
+
+            OBJStream::Batch _batch;
+            VS _va;
+            TS _ta;
+
+            BatchAttribute(const OBJStream::Batch& batch) :
+            _batch{ batch },
+            _va{ MeshIndex(batch.vertices.size()) },
+            _ta{ MeshIndex(batch.triangles.size()) }
+            {}
+
+    };
+
 }
 
 #endif
\ No newline at end of file
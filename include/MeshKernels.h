@@ -0,0 +1,56 @@
+#ifndef __MeshKernels_h
+#define __MeshKernels_h
+
+// OVERVIEW: MeshKernels.h
+// ========
+// Vectorized kernels used by mesh algorithms. The instruction set
+// (SSE, AVX2 or AVX-512) is chosen at run time.
+//
+// Last revision: 17/10/2026
+
+#include "Vec3View.h"
+#include <cstddef>
+
+namespace tcii::cg::kernels
+{ // begin namespace tcii::cg::kernels
+
+using PointColumns = Vec3View<const float>;
+
+// Returns the name of the instruction set used by the kernels
+const char* isaName();
+
+//
+// Computes the unit normals of count triangles whose vertex indices
+// are the triplets in indices. Normal k is stored in nx[k], ny[k] and
+// nz[k].
+//
+void faceNormals(const PointColumns& points,
+  const unsigned* indices,
+  size_t count,
+  float* nx,
+  float* ny,
+  float* nz);
+
+//
+// Sets brightness[k] to the sum, over the lights, of intensity *
+// max(0, n . l), where n is the normalized sum of the vertex normals
+// of triangle k (whose vertex indices are the triplets in indices).
+// Light j is given by lights[4j..4j+3]: the unit direction towards
+// the light followed by its intensity.
+//
+void lambert(const PointColumns& normals,
+  const unsigned* indices,
+  size_t count,
+  const float* lights,
+  size_t lightCount,
+  float* brightness);
+
+// Normalizes the vectors of v in place
+void normalize(const Vec3View<float>& v);
+
+// Extends min and max to enclose the points; NaNs are ignored
+void bounds(const PointColumns& points, Vec3f& min, Vec3f& max);
+
+} // end namespace tcii::cg::kernels
+
+#endif // __MeshKernels_h
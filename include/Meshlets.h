@@ -0,0 +1,151 @@
+#ifndef __Meshlets_h
+#define __Meshlets_h
+
+// OVERVIEW: Meshlets.h
+// ========
+// Class definition for meshlets.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include "util/Parallel.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Meshlets: clusters of at most maxVertices vertices and maxTriangles
+// ========  triangles of a mesh
+// Each meshlet has a vertex buffer of mesh vertex indices and a buffer
+// of triangles indexing it, plus its bounds and normal cone. Meshlets
+// are grown over shared vertices within regions of consecutive mesh
+// triangles, so the vertex cache and Morton orders of the mesh give
+// compact meshlets; the regions are built in parallel. Like the BVH,
+// meshlets are a snapshot of the mesh.
+//
+class Meshlets: public SharedObject
+{
+public:
+  using index_t = TriangleMesh::index_t;
+  using vec3 = TriangleMesh::vec3;
+  using Bounds = TriangleMesh::Bounds;
+  using Triangle = Index3<uint8_t>;
+
+  static constexpr unsigned maxVertices = 64;
+  static constexpr unsigned maxTriangles = 124;
+
+  struct Meshlet
+  {
+    index_t vertexOffset;
+    index_t triangleOffset;
+    uint8_t vertexCount;
+    uint8_t triangleCount;
+
+  }; // Meshlet
+
+  // Bounding box and sphere, and the cone containing the normals of
+  // the triangles: a normal n is in the cone if n . axis >= cutoff.
+  // Meshlets whose cutoff is not positive are never back-face culled
+  struct Culling
+  {
+    Bounds bounds;
+    vec3 center;
+    float radius;
+    vec3 axis;
+    float cutoff;
+
+  }; // Culling
+
+  static ObjectPtr<Meshlets> New(const TriangleMesh& mesh)
+  {
+    return new Meshlets{mesh};
+  }
+
+  auto& mesh() const
+  {
+    return *_mesh;
+  }
+
+  auto count() const
+  {
+    return (index_t)_meshlets.size();
+  }
+
+  auto& meshlet(index_t i) const
+  {
+    assert(i < count());
+    return _meshlets[i];
+  }
+
+  auto& culling(index_t i) const
+  {
+    assert(i < count());
+    return _culling[i];
+  }
+
+  // Mesh vertices of meshlet i
+  ArrayView<index_t> vertices(index_t i) const
+  {
+    auto& m = meshlet(i);
+    return {_vertices.data() + m.vertexOffset, m.vertexCount};
+  }
+
+  // Triangles of meshlet i, indexing vertices(i)
+  ArrayView<Triangle> triangles(index_t i) const
+  {
+    auto& m = meshlet(i);
+    return {_triangles.data() + m.triangleOffset, m.triangleCount};
+  }
+
+  // Mesh triangles of meshlet i, in the order of triangles(i)
+  ArrayView<index_t> triangleIndices(index_t i) const
+  {
+    auto& m = meshlet(i);
+    return {_triangleIndices.data() + m.triangleOffset, m.triangleCount};
+  }
+
+  // Whether all triangles of meshlet i face away from eye
+  bool backfacing(index_t i, const vec3& eye) const;
+
+  // Calls f(i, k) for every meshlet i on all threads, k being the
+  // thread. Meshlets are handed out one at a time
+  template <typename F>
+  void forEach(F&& f) const
+  {
+    std::atomic<index_t> next{0};
+    auto n = count();
+
+    parallelRun(std::min(threadCount(), n), [&](unsigned k)
+    {
+      for (index_t i; (i = next++) < n;)
+        f(i, k);
+    });
+  }
+
+  auto memorySize() const
+  {
+    return _meshlets.size() * (sizeof(Meshlet) + sizeof(Culling)) +
+      _vertices.size() * sizeof(index_t) +
+      _triangles.size() * (sizeof(Triangle) + sizeof(index_t));
+  }
+
+private:
+  ObjectPtr<TriangleMesh> _mesh;
+  std::vector<Meshlet> _meshlets;
+  std::vector<Culling> _culling;
+  std::vector<index_t> _vertices;
+  std::vector<Triangle> _triangles;
+  std::vector<index_t> _triangleIndices;
+
+  Meshlets(const TriangleMesh& mesh);
+
+}; // Meshlets
+
+} // end namespace tcii::cg
+
+#endif // __Meshlets_h
@@ -0,0 +1,108 @@
+#ifndef __OBJStream_h
+#define __OBJStream_h
+
+// OVERVIEW: OBJStream.h
+// ========
+// Class definition for streaming Wavefront OBJ reader.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// OBJStream: streaming Wavefront OBJ reader
+// =========
+// Reads an OBJ file as a sequence of batches holding at most
+// batchSize() vertices and batchSize() triangles each (a polygon is
+// never split across batches, so a batch can exceed the limit by the
+// size of its last polygon fan). Memory use depends on the batch size,
+// not on the file size. Triangle indices refer to the vertices of the
+// whole file. Vertex normals are not computed, since they depend on
+// triangles that may come in later batches.
+//
+// Usage:
+//
+//   auto stream = OBJStream::New(filename, 4096);
+//   OBJStream::Batch batch;
+//
+//   while (stream->next(batch))
+//     for (index_t i{}; i < batch.vertices.size(); ++i)
+//       process(batch.vertexBase + i, batch.vertices[i]);
+//
+// BatchAttribute (see MeshAttribute.h) holds the attributes of the
+// elements of a batch.
+//
+class OBJStream: public SharedObject
+{
+public:
+  using index_t = TriangleMesh::index_t;
+  using vec3 = TriangleMesh::vec3;
+  using Triangle = TriangleMesh::Triangle;
+
+  struct Batch
+  {
+    index_t vertexBase; // index of vertices[0] in the file
+    TriangleMesh::Vec3Array vertices;
+    index_t triangleBase; // index of triangles[0] in the file
+    TriangleMesh::TriangleArray triangles;
+
+  }; // Batch
+
+  static constexpr size_t defaultBatchSize = 1 << 16;
+
+  ~OBJStream() override;
+
+  auto batchSize() const
+  {
+    return _batchSize;
+  }
+
+  // Number of vertices/triangles read so far
+  auto vertexCount() const
+  {
+    return _vertexBase + (index_t)_vertices.size();
+  }
+
+  auto triangleCount() const
+  {
+    return _triangleBase + (index_t)_triangles.size();
+  }
+
+  // Reads the next batch. Returns false if there are no more records.
+  // The arrays of the batch are valid until the next call
+  bool next(Batch& batch);
+
+  // Returns nullptr if the file cannot be opened
+  static ObjectPtr<OBJStream> New(const char* filename,
+    size_t batchSize = defaultBatchSize);
+
+private:
+  FILE* _file;
+  size_t _batchSize;
+  std::vector<char> _buffer;
+  size_t _begin{}; // first unread byte
+  size_t _lineEnd{}; // end of the complete lines in the buffer
+  size_t _end{}; // end of the data in the buffer
+  bool _eof{};
+  std::vector<vec3> _vertices;
+  std::vector<Triangle> _triangles;
+  index_t _vertexBase{};
+  index_t _triangleBase{};
+
+  OBJStream(FILE* file, size_t batchSize);
+
+  bool fill();
+
+  friend struct OBJStreamOutput;
+
+}; // OBJStream
+
+} // end namespace tcii::cg
+
+#endif // __OBJStream_h
@@ -0,0 +1,49 @@
+#ifndef __Simplification_h
+#define __Simplification_h
+
+// OVERVIEW: Simplification.h
+// ========
+// Function declaration for quadric error mesh simplification.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+struct LevelOfDetail
+{
+  ObjectPtr<TriangleMesh> mesh;
+  // Vertex i of mesh is vertex vertexMap[i] of the source mesh, moved
+  // by the collapses that merged its neighbors into it; vertex
+  // attributes of the source mesh are carried through this map
+  std::vector<TriangleMesh::index_t> vertexMap;
+  // Largest quadric error (a sum of squared distances) of the
+  // collapses made to reach this level
+  float error;
+
+}; // LevelOfDetail
+
+//
+// Simplifies the mesh by edge collapses ordered by quadric error
+// (Garland and Heckbert, Surface simplification using quadric error
+// metrics, 1997) and returns one level of detail per ratio, with about
+// ratio * triangleCount triangles. The ratios must be decreasing: each
+// level continues the collapses of the previous one. Collapses that
+// flip a triangle or would make the surface non-manifold are skipped,
+// so a level may have more triangles than asked for.
+//
+// Large meshes are split into spatial partitions that are simplified
+// in parallel, keeping the vertices on partition borders; the
+// collapses left are then made over the whole mesh. The partitions do
+// not depend on the number of threads, nor does the result.
+//
+std::vector<LevelOfDetail> simplify(const TriangleMesh& mesh,
+  const float* ratios,
+  size_t count);
+
+} // end namespace tcii::cg
+
+#endif // __Simplification_h
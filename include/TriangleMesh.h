@@ -6,12 +6,19 @@
 // Class definition for triangle mesh.
 //
 // Author: Paulo Pagliosa
-// Last revision: 06/07/2025
+// Last revision: 17/10/2026
 
 #include "graphics/Bounds3.h"
 #include "util/SharedObject.h"
+#include "util/SoA.h"
 #include "ArrayView.h"
+#include "AlignedSoAAllocator.h"
+#include "Vec3View.h"
 #include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace tcii::cg
 { // begin namespace tcii::cg
@@ -58,18 +65,64 @@ public:
   using Bounds = Bounds3f;
   using Triangle = Index3<index_t>;
   using TriangleArray = ArrayView<Triangle>;
-  using Vec3Array = ArrayView<vec3>;
+  using Vec3Array = Vec3View<const float>;
+  using Vec3Ref = tcii::cg::Vec3Ref<float>;
+  using Vec3Columns = SoA<AlignedSoAAllocator<>, index_t, float, float, float>;
+
+  // Storage of vertex positions and normals
+  enum class VertexLayout
+  {
+    AoS, // arrays of vec3
+    SoA // separate x, y and z columns
+  };
 
   class Data
   {
   public:
     Data(index_t vertexSize, index_t triangleSize);
 
+    // Takes ownership of arrays obtained from allocate()/reallocate()
+    Data(index_t vertexSize,
+      vec3* vertices,
+      index_t triangleSize,
+      Triangle* triangles);
+
+    // Uses arrays that live in memory owned by storage (e.g., a mapped
+    // file); the arrays are released together with storage. Arrays
+    // that later replace them are owned by the mesh
+    Data(const SharedObject* storage,
+      index_t vertexSize,
+      vec3* vertices,
+      vec3* vertexNormals,
+      index_t triangleSize,
+      Triangle* triangles);
+
     ~Data()
     {
-      delete[]_vertices;
-      delete[]_vertexNormals;
-      delete[]_triangles;
+      release(_vertices);
+      release(_vertexNormals);
+      release(_triangles);
+    }
+
+    // Mesh arrays hold trivially copyable elements and are managed
+    // with malloc/realloc, so loaders can grow them in place and hand
+    // them over to a Data object without copying
+    template <typename T>
+    static T* allocate(size_t count)
+    {
+      return reallocate<T>(nullptr, count);
+    }
+
+    template <typename T>
+    static T* reallocate(T* ptr, size_t count)
+    {
+      static_assert(std::is_trivially_copyable_v<T>);
+      if (count == 0)
+      {
+        std::free(ptr);
+        return nullptr;
+      }
+      return (T*)std::realloc(ptr, count * sizeof(T));
     }
 
     auto vertexCount() const
@@ -77,36 +130,63 @@ public:
       return _vertexSize;
     }
 
-    auto& vertex(index_t i)
+    auto vertexLayout() const
     {
-      assert(i < _vertexSize);
-      return _vertices[i];
+      return _layout;
     }
 
-    auto& vertex(index_t i) const
+    // Vertices and vertex normals are accessed through views and
+    // references that work with either layout. In the SoA layout,
+    // the columns can also be accessed directly
+    Vec3Ref vertex(index_t i)
     {
-      return const_cast<Data*>(this)->vertex(i);
+      return mutableVertices().ref(i);
+    }
+
+    vec3 vertex(index_t i) const
+    {
+      return vertices()[i];
     }
 
     Vec3Array vertices() const
     {
-      return {_vertices, _vertexSize};
+      return const_cast<Data*>(this)->mutableVertices();
     }
 
-    auto& vertexNormal(index_t i)
+    Vec3Ref vertexNormal(index_t i)
     {
-      assert(_vertexNormals && i < _vertexSize);
-      return _vertexNormals[i];
+      assert(hasVertexNormals());
+      return mutableVertexNormals().ref(i);
     }
 
-    auto& vertexNormal(index_t i) const
+    vec3 vertexNormal(index_t i) const
     {
-      return const_cast<Data*>(this)->vertexNormal(i);
+      assert(hasVertexNormals());
+      return vertexNormals()[i];
     }
 
     Vec3Array vertexNormals() const
     {
-      return {_vertexNormals, _vertexSize};
+      return const_cast<Data*>(this)->mutableVertexNormals();
+    }
+
+    bool hasVertexNormals() const
+    {
+      return _layout == VertexLayout::AoS ?
+        _vertexNormals != nullptr :
+        _normalColumns.size() != 0;
+    }
+
+    auto& vertexColumns() const
+    {
+      assert(_layout == VertexLayout::SoA);
+      return _vertexColumns;
+    }
+
+    auto& normalColumns() const
+    {
+      assert(_layout == VertexLayout::SoA);
+      return _normalColumns;
     }
 
     auto triangleCount() const
@@ -133,16 +213,157 @@ public:
   private:
     index_t _vertexSize;
     index_t _triangleSize;
+    VertexLayout _layout{VertexLayout::AoS};
     vec3* _vertices;
     vec3* _vertexNormals{};
     Triangle* _triangles;
+    Vec3Columns _vertexColumns;
+    Vec3Columns _normalColumns;
+    ObjectPtr<SharedObject> _storage;
+    // Arrays that live in the storage object
+    const void* _storageArrays[3]{};
+
+    Data(Data&& other) noexcept;
+
+    static auto columns(Vec3Columns& c)
+    {
+      return Vec3View<float>{c.data<0>(), c.data<1>(), c.data<2>(), c.size()};
+    }
 
-    Data(const Data&) = default;
+    Vec3View<float> mutableVertices()
+    {
+      if (_layout == VertexLayout::SoA)
+        return columns(_vertexColumns);
+      return {_vertices, _vertexSize};
+    }
+
+    Vec3View<float> mutableVertexNormals()
+    {
+      if (_layout == VertexLayout::SoA)
+        return _normalColumns.size() ? columns(_normalColumns) : Vec3View<float>{};
+      return {_vertexNormals, _vertexNormals ? _vertexSize : 0};
+    }
+
+    bool inStorage(const void* array) const
+    {
+      return array != nullptr &&
+        (array == _storageArrays[0] ||
+        array == _storageArrays[1] ||
+        array == _storageArrays[2]);
+    }
+
+    // Frees an array unless it belongs to the storage object, which is
+    // dropped once no array lives in it
+    template <typename T>
+    void release(T*& array)
+    {
+      if (!inStorage(array))
+        std::free(array);
+      array = nullptr;
+      if (_storage != nullptr &&
+        !inStorage(_vertices) &&
+        !inStorage(_vertexNormals) &&
+        !inStorage(_triangles))
+      {
+        _storage = nullptr;
+        _storageArrays[0] = _storageArrays[1] = _storageArrays[2] = nullptr;
+      }
+    }
 
     friend TriangleMesh;
 
   }; // Data
 
+  /////////////////////////////////////////////////////////////////
+  //
+  // Adjacency: vertex-to-triangle adjacency
+  // =========
+  // Compressed sparse rows: the triangles incident to vertex v are
+  // triangleIndices()[offsets()[v]..offsets()[v + 1]), in increasing
+  // order. Uses 4 * (nv + 1 + 3 * nt) bytes.
+  //
+  class Adjacency
+  {
+  public:
+    using IndexArray = ArrayView<index_t>;
+
+    auto vertexCount() const
+    {
+      return index_t(_offsets.size() - 1);
+    }
+
+    auto degree(index_t v) const
+    {
+      assert(v < vertexCount());
+      return _offsets[v + 1] - _offsets[v];
+    }
+
+    IndexArray triangles(index_t v) const
+    {
+      assert(v < vertexCount());
+      return {_triangles.data() + _offsets[v], degree(v)};
+    }
+
+    IndexArray offsets() const
+    {
+      return {_offsets.data(), _offsets.size()};
+    }
+
+    IndexArray triangleIndices() const
+    {
+      return {_triangles.data(), _triangles.size()};
+    }
+
+    auto memorySize() const
+    {
+      return (_offsets.size() + _triangles.size()) * sizeof(index_t);
+    }
+
+  private:
+    std::vector<index_t> _offsets;
+    std::vector<index_t> _triangles;
+
+    Adjacency(const Data& data);
+
+    friend TriangleMesh;
+
+  }; // Adjacency
+
+  /////////////////////////////////////////////////////////////////
+  //
+  // Observer: object notified when the mesh elements are reordered
+  // ========
+  class Observer
+  {
+  public:
+    // Detaches the observer from its mesh
+    virtual ~Observer();
+
+    Observer(const Observer&) = delete;
+    Observer& operator =(const Observer&) = delete;
+
+    // Vertex i is now the vertex that was at order[i]
+    virtual void verticesReordered(const index_t* order)
+    {
+      // do nothing
+    }
+
+    // Triangle i is now the triangle that was at order[i]
+    virtual void trianglesReordered(const index_t* order)
+    {
+      // do nothing
+    }
+
+  protected:
+    // Attaches the observer to the mesh, which is kept alive until
+    // the observer is destroyed
+    Observer(const TriangleMesh& mesh);
+
+  private:
+    ObjectPtr<TriangleMesh> _mesh;
+
+  }; // Observer
+
   TriangleMesh(Data&& data);
 
   auto& data() const
@@ -152,21 +373,124 @@ public:
 
   bool hasVertexNormals() const
   {
-    return _data._vertexNormals;
+    return _data.hasVertexNormals();
   }
 
   void computeVertexNormals();
 
-  Bounds& bounds() const;
+  // Converts the vertex positions and normals to the given layout
+  void setVertexLayout(VertexLayout layout);
+
+  void setVertex(index_t i, const vec3& p)
+  {
+    _data.vertex(i) = p;
+    invalidateBounds();
+  }
+
+  // Sets the positions of vertices ids[0..count) and updates the
+  // normals of the vertices of their triangles, if the mesh has
+  // normals, and the bounds. The cost depends on the number of vertices
+  // moved and the size of their one-rings, not on the size of the mesh
+  void updateVertices(const index_t* ids, const vec3* positions, size_t count);
+
+  // Same for the vertices in [first, first + count)
+  void updateVertices(index_t first, const vec3* positions, size_t count);
+
+  // Bounds are computed on demand and cached until invalidated. Safe
+  // to call from several threads; a copy is returned, since the cache
+  // may be recomputed by another thread
+  Bounds bounds() const;
+
+  void invalidateBounds()
+  {
+    std::lock_guard lock{_lock};
+    _boundsValid = false;
+  }
+
+  // Builds the vertex-to-triangle adjacency on first use and caches it
+  // until invalidated. Safe to call from several threads
+  const Adjacency& adjacency() const;
+
+  void invalidateAdjacency()
+  {
+    std::lock_guard lock{_lock};
+    _adjacency.reset();
+  }
+
+
+  // Moves vertex order[i] to position i, renumbers the triangles and
+  // notifies the observers
+  void reorderVertices(const index_t* order);
+
+  // Sorts the vertices along a Morton curve inside the mesh bounds.
+  // Returns the order passed to reorderVertices()
+  std::vector<index_t> sortVertices();
+
+  // Moves triangle order[i] to position i and notifies the observers
+  void reorderTriangles(const index_t* order);
+
+  // Numbers of vertices and triangles removed by weld() and the memory
+  // they took
+  struct WeldResult
+  {
+    index_t vertices;
+    index_t triangles;
+    size_t bytes;
+
+  }; // WeldResult
+
+  // Merges the vertices within epsilon of each other (the coincident
+  // ones, if epsilon is 0), renumbers the triangles and drops those
+  // that become degenerate. Vertex normals, if any, are recomputed.
+  // The numbers of vertices and triangles change, so attributes must
+  // be created after welding
+  WeldResult weld(float epsilon = 0);
+
+  // Reorders the triangles for a post-transform vertex cache with the
+  // given number of entries (Tipsify)
+  void optimizeVertexCache(unsigned cacheSize = 16);
+
+  // Average cache miss ratio, i.e., the number of vertices transformed
+  // per triangle, for a FIFO vertex cache with the given size
+  float acmr(unsigned cacheSize = 16) const;
+
   void print(const char* label, FILE* file = stdout) const;
 
 private:
   Data _data;
   mutable Bounds _bounds;
+  mutable bool _boundsValid{};
+  mutable std::unique_ptr<Adjacency> _adjacency;
+  // Observers are not part of the mesh state, so they can be attached
+  // to (and detached from) a const mesh
+  mutable std::vector<Observer*> _observers;
+  mutable std::mutex _lock;
+
+  template <typename Id>
+  void moveVertices(Id id, const vec3* positions, size_t count);
+
+  // Copy of the observers, which are notified without holding the lock
+  // so they can use the mesh
+  auto observers() const
+  {
+    std::lock_guard lock{_lock};
+    return _observers;
+  }
 
 }; // TriangleMesh
 
-ObjectPtr<TriangleMesh> readOBJ(const char* filename);
+// Welds the vertices of the mesh read (see TriangleMesh::weld()) if
+// weldEpsilon is not negative
+ObjectPtr<TriangleMesh> readOBJ(const char* filename,
+  float weldEpsilon = -1);
+
+// Binary mesh cache. If source is not null, the size and modification
+// time of that file are recorded in (and checked against) the cache
+bool writeMeshCache(const TriangleMesh& mesh,
+  const char* filename,
+  const char* source = nullptr);
+ObjectPtr<TriangleMesh> readMeshCache(const char* filename,
+  const char* source = nullptr);
 
 } // end namespace tcii::cg
 
@@ -0,0 +1,189 @@
+#ifndef __Vec3View_h
+#define __Vec3View_h
+
+// OVERVIEW: Vec3View.h
+// ========
+// Class definitions for views of 3D vector arrays.
+//
+// Last revision: 17/10/2026
+
+#include "graphics/Vec3.h"
+#include <type_traits>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Vec3Ref: reference to a 3D vector of a Vec3View
+// ======
+template <typename real>
+class Vec3Ref
+{
+public:
+  using vec3 = Vec3<real>;
+
+  Vec3Ref(real* x, real* y, real* z):
+    _x{x},
+    _y{y},
+    _z{z}
+  {
+    // do nothing
+  }
+
+  operator vec3() const
+  {
+    return {*_x, *_y, *_z};
+  }
+
+  auto& operator =(const vec3& v)
+  {
+    *_x = v.x;
+    *_y = v.y;
+    *_z = v.z;
+    return *this;
+  }
+
+  auto& operator =(const Vec3Ref& other)
+  {
+    return operator =((vec3)other);
+  }
+
+private:
+  real* _x;
+  real* _y;
+  real* _z;
+
+}; // Vec3Ref
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Vec3View: view of an array of 3D vectors
+// ========
+// The vectors can be stored either as an array of Vec3 (AoS) or as
+// three coordinate columns (SoA). Vector i has coordinates x()[i * s],
+// y()[i * s] and z()[i * s], where s = stride() is 3 for an array of
+// Vec3 and 1 for columns. real is const qualified for read-only views.
+//
+template <typename real>
+class Vec3View
+{
+public:
+  using value_type = Vec3<std::remove_const_t<real>>;
+  using pointer = std::conditional_t<std::is_const_v<real>,
+    const value_type*,
+    value_type*>;
+
+  Vec3View() = default;
+
+  Vec3View(pointer data, size_t size):
+    _x{data ? &data->x : nullptr},
+    _y{data ? &data->y : nullptr},
+    _z{data ? &data->z : nullptr},
+    _stride{3},
+    _size{size}
+  {
+    // do nothing
+  }
+
+  Vec3View(real* x, real* y, real* z, size_t size):
+    _x{x},
+    _y{y},
+    _z{z},
+    _stride{1},
+    _size{size}
+  {
+    // do nothing
+  }
+
+  template <typename T>
+    requires (!std::is_same_v<T, real> && std::is_same_v<const T, real>)
+  Vec3View(const Vec3View<T>& other):
+    _x{other.x()},
+    _y{other.y()},
+    _z{other.z()},
+    _stride{other.stride()},
+    _size{other.size()}
+  {
+    // do nothing
+  }
+
+  auto size() const
+  {
+    return _size;
+  }
+
+  bool empty() const
+  {
+    return !_x;
+  }
+
+  auto stride() const
+  {
+    return _stride;
+  }
+
+  auto x() const
+  {
+    return _x;
+  }
+
+  auto y() const
+  {
+    return _y;
+  }
+
+  auto z() const
+  {
+    return _z;
+  }
+
+  // Returns the array of Vec3, or nullptr if the view is of columns
+  pointer data() const
+  {
+    return _stride == 3 ? (pointer)_x : nullptr;
+  }
+
+  // Returns the view of the count vectors starting at first
+  auto subview(size_t first, size_t count) const
+  {
+    assert(first + count <= _size);
+
+    auto v = *this;
+    auto offset = first * _stride;
+
+    v._x += offset;
+    v._y += offset;
+    v._z += offset;
+    v._size = count;
+    return v;
+  }
+
+  value_type operator [](size_t i) const
+  {
+    assert(i < _size);
+    i *= _stride;
+    return {_x[i], _y[i], _z[i]};
+  }
+
+  auto ref(size_t i) const requires (!std::is_const_v<real>)
+  {
+    assert(i < _size);
+    i *= _stride;
+    return Vec3Ref<real>{_x + i, _y + i, _z + i};
+  }
+
+private:
+  real* _x{};
+  real* _y{};
+  real* _z{};
+  size_t _stride{};
+  size_t _size{};
+
+}; // Vec3View
+
+} // end namespace tcii::cg
+
+#endif // __Vec3View_h
@@ -73,6 +73,24 @@ operator *(const Vec3<real>& v, real s)
   return s * v;
 }
 
+template <typename real>
+inline real
+dot(const Vec3<real>& u, const Vec3<real>& v)
+{
+  return u.x * v.x + u.y * v.y + u.z * v.z;
+}
+
+template <typename real>
+inline Vec3<real>
+cross(const Vec3<real>& u, const Vec3<real>& v)
+{
+  const auto x = u.y * v.z - u.z * v.y;
+  const auto y = u.z * v.x - u.x * v.z;
+  const auto z = u.x * v.y - u.y * v.x;
+
+  return {x, y, z};
+}
+
 template <typename real>
 inline real
 Vec<3, real>::length() const
@@ -0,0 +1,77 @@
+#ifndef __MappedFile_h
+#define __MappedFile_h
+
+// OVERVIEW: MappedFile.h
+// ========
+// Class definition for memory-mapped file.
+//
+// Last revision: 17/10/2026
+
+#include "util/SharedObject.h"
+#include <cassert>
+#include <cstddef>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MappedFile: class for memory-mapped file
+// ==========
+class MappedFile: public SharedObject
+{
+public:
+  enum class Access
+  {
+    ReadOnly,
+    CopyOnWrite // pages can be written; changes are never flushed
+  };
+
+  ~MappedFile() override;
+
+  auto data() const
+  {
+    return (const char*)_data;
+  }
+
+  auto data()
+  {
+    return (char*)_data;
+  }
+
+  auto size() const
+  {
+    return _size;
+  }
+
+  auto access() const
+  {
+    return _access;
+  }
+
+  // Hints that the mapping will be read from front to back
+  void adviseSequential() const;
+
+  // Returns nullptr if the file cannot be mapped (or is empty)
+  static ObjectPtr<MappedFile> New(const char* filename,
+    Access access = Access::ReadOnly);
+
+private:
+  void* _data;
+  size_t _size;
+  Access _access;
+
+  MappedFile(void* data, size_t size, Access access):
+    _data{data},
+    _size{size},
+    _access{access}
+  {
+    // do nothing
+  }
+
+}; // MappedFile
+
+} // end namespace tcii::cg
+
+#endif // __MappedFile_h
@@ -0,0 +1,144 @@
+#ifndef __Parallel_h
+#define __Parallel_h
+
+// OVERVIEW: Parallel.h
+// ========
+// Helpers for running loops on several threads.
+//
+// Last revision: 17/10/2026
+
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+// Minimum numbers of vertices and triangles handled by a thread in
+// loops that do little work per element
+constexpr size_t minVerticesPerBlock = 1 << 16;
+constexpr size_t minTrianglesPerBlock = 1 << 14;
+
+inline unsigned
+threadCount()
+{
+  static const auto n = std::max(std::thread::hardware_concurrency(), 1u);
+  return n;
+}
+
+//
+// Runs f(k) for k in [0, n) on the threads of the shared pool, the
+// calling thread included (see ThreadPool). The first exception thrown
+// by a call is rethrown after all calls have finished.
+//
+template <typename F>
+void
+parallelRun(unsigned n, F&& f)
+{
+  if (n <= 1)
+  {
+    if (n == 1)
+      f(0u);
+    return;
+  }
+  ThreadPool::instance().run(n, [&f](size_t k)
+  {
+    f(unsigned(k));
+  });
+}
+
+//
+// Returns the number of blocks [0, n) is split into by parallelFor()
+//
+inline unsigned
+blockCount(size_t n, size_t grain)
+{
+  auto m = (n + grain - 1) / std::max<size_t>(grain, 1);
+  return (unsigned)std::min<size_t>(m, threadCount());
+}
+
+//
+// Splits [0, n) into contiguous blocks of at least grain elements,
+// one per thread, and calls f(begin, end, block) for each block.
+// The partition depends only on n, grain and the thread count.
+//
+template <typename F>
+void
+parallelFor(size_t n, size_t grain, F&& f)
+{
+  auto m = blockCount(n, grain);
+
+  parallelRun(m, [&](unsigned k)
+  {
+    f(n * k / m, n * (k + 1) / m, k);
+  });
+}
+
+//
+// Splits [0, n) into chunks of grain elements, the last one possibly
+// shorter, and calls f(begin, end) for each chunk. Chunks are balanced
+// among the threads by work stealing, so grain can be much smaller
+// than n / threadCount().
+//
+template <typename F>
+void
+parallelForChunks(size_t n, size_t grain, F&& f)
+{
+  grain = std::max<size_t>(grain, 1);
+
+  auto m = (n + grain - 1) / grain;
+
+  if (m <= 1 || threadCount() == 1)
+  {
+    for (size_t b = 0; b < n; b += grain)
+      f(b, std::min(b + grain, n));
+    return;
+  }
+  ThreadPool::instance().run(m, [&](size_t k)
+  {
+    f(k * grain, std::min((k + 1) * grain, n));
+  });
+}
+
+//
+// Replaces a[i] by a[0] + ... + a[i]. Each thread scans a block of a;
+// the block totals are then added to the blocks that follow them.
+//
+template <typename T>
+void
+parallelInclusiveScan(T* a, size_t n, size_t grain = 1 << 16)
+{
+  auto m = blockCount(n, grain);
+
+  if (m <= 1)
+  {
+    for (size_t i = 1; i < n; ++i)
+      a[i] += a[i - 1];
+    return;
+  }
+
+  std::vector<T> sums(m + 1);
+
+  parallelFor(n, grain, [&](size_t b, size_t e, unsigned k)
+  {
+    T s{};
+
+    for (auto i = b; i < e; ++i)
+      s += a[i];
+    sums[k + 1] = s;
+  });
+  for (size_t k = 1; k <= m; ++k)
+    sums[k] += sums[k - 1];
+  parallelFor(n, grain, [&](size_t b, size_t e, unsigned k)
+  {
+    auto s = sums[k];
+
+    for (auto i = b; i < e; ++i)
+      a[i] = s += a[i];
+  });
+}
+
+} // end namespace tcii::cg
+
+#endif // __Parallel_h
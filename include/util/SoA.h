@@ -6,11 +6,20 @@
 // Class definition for structure of arrays (SoA).
 //
 // Author: Paulo Pagliosa
-// Last revision: 06/07/2025
+// Last revision: 17/10/2026
 
+#include "util/Parallel.h"
+#include <algorithm>
 #include <cassert>
 #include <concepts>
+#include <compare>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <tuple>
+#include <utility>
 
 namespace tcii::cg
 { // begin namespace tcii::cg
@@ -24,6 +33,15 @@ concept IsAllocator = requires (size_t n, T* ptr)
   { A::template free<T>(ptr) };
 };
 
+// Allocator of blocks aligned to A::alignment bytes
+template <typename A>
+concept IsBlockAllocator = requires (size_t n, void* block)
+{
+  { A::alignment } -> std::convertible_to<size_t>;
+  { A::allocateBlock(n) } -> std::same_as<void*>;
+  { A::freeBlock(block) };
+};
+
 template <typename index_t, typename... Args> class SoABase;
 
 namespace soa
@@ -92,6 +110,37 @@ public:
     // do nothing
   }
 
+  template <typename... Values>
+  void emplace(index_t i, Values&&...)
+  {
+    // do nothing
+  }
+
+  static constexpr size_t blockSize(size_t, size_t)
+  {
+    return 0;
+  }
+
+  void carve(char* block, size_t count, size_t alignment)
+  {
+    // do nothing
+  }
+
+  void destroy(size_t count)
+  {
+    // do nothing
+  }
+
+  void permute(Arrays& to, const index_t* order, size_t count)
+  {
+    // do nothing
+  }
+
+  void move(Arrays& to, size_t count)
+  {
+    // do nothing
+  }
+
 }; // Arrays
 
 template <typename index_t, typename T, typename... Args>
@@ -148,21 +197,165 @@ public:
     Base::swap(i, j);
   }
 
+  template <typename Value, typename... Values>
+  void emplace(index_t i, Value&& value, Values&&... values)
+  {
+    data[i] = T(std::forward<Value>(value));
+    Base::emplace(i, std::forward<Values>(values)...);
+  }
+
+  // Bytes of the columns carved out of a block, each column padded to
+  // a multiple of alignment
+  static constexpr size_t blockSize(size_t count, size_t alignment)
+  {
+    return columnSize(count, alignment) + Base::blockSize(count, alignment);
+  }
+
+  void carve(char* block, size_t count, size_t alignment)
+  {
+    auto size = count * sizeof(T);
+
+    data = reinterpret_cast<T*>(block);
+    std::uninitialized_default_construct_n(data, count);
+    memset(block + size, 0, columnSize(count, alignment) - size);
+    Base::carve(block + columnSize(count, alignment), count, alignment);
+  }
+
+  void destroy(size_t count)
+  {
+    std::destroy_n(data, count);
+    Base::destroy(count);
+  }
+
+  // Moves element order[i] to position i of to, for all i
+  void permute(Arrays& to, const index_t* order, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+      to.data[i] = std::move(data[order[i]]);
+    Base::permute(to.base(), order, count);
+  }
+
+  // Moves the first count elements to to
+  void move(Arrays& to, size_t count)
+  {
+    if constexpr (std::is_trivially_copyable_v<T>)
+      memcpy(to.data, data, count * sizeof(T));
+    else
+      std::move(data, data + count, to.data);
+    Base::move(to.base(), count);
+  }
+
+private:
+  static constexpr size_t columnSize(size_t count, size_t alignment)
+  {
+    return (count * sizeof(T) + alignment - 1) / alignment * alignment;
+  }
+
 }; // Arrays
 
+// Allocator from whose blocks an SoA carves all its columns
+template <typename A, typename... Args>
+concept IsArenaAllocator = sizeof...(Args) > 0 && IsBlockAllocator<A> &&
+  ((alignof(Args) <= A::alignment) && ...);
+
 } // end namespace soa
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// SoAReference: SoA element reference class
+// ============
+// Proxy for the fields of an SoA element, returned by dereferencing an
+// SoA iterator. It is a tuple of references to the fields, so std::get
+// and the tuple comparisons apply to it, and it converts to the tuple
+// of the field values. Assigning to a reference, even a const one,
+// assigns the fields of the element, and swapping two references swaps
+// their elements, which lets std algorithms permute SoAs.
+//
+template <typename... Args>
+class SoAReference: public std::tuple<Args&...>
+{
+public:
+  using value_type = std::tuple<std::remove_const_t<Args>...>;
+
+  explicit SoAReference(Args&... args):
+    std::tuple<Args&...>{args...}
+  {
+    // do nothing
+  }
+
+  SoAReference(const SoAReference&) = default;
+
+  template <size_t I>
+  auto& get() const
+  {
+    return std::get<I>(tuple());
+  }
+
+  const SoAReference& operator =(const SoAReference& other) const
+  {
+    assign(other.tuple(), std::index_sequence_for<Args...>{});
+    return *this;
+  }
+
+  const SoAReference& operator =(const value_type& t) const
+  {
+    assign(t, std::index_sequence_for<Args...>{});
+    return *this;
+  }
+
+  const SoAReference& operator =(value_type&& t) const
+  {
+    assign(std::move(t), std::index_sequence_for<Args...>{});
+    return *this;
+  }
+
+  friend void swap(const SoAReference& a, const SoAReference& b)
+  {
+    a.swap(b, std::index_sequence_for<Args...>{});
+  }
+
+private:
+  const std::tuple<Args&...>& tuple() const
+  {
+    return *this;
+  }
+
+  template <typename T, size_t... I>
+  void assign(T&& t, std::index_sequence<I...>) const
+  {
+    ((std::get<I>(tuple()) = std::get<I>(std::forward<T>(t))), ...);
+  }
+
+  template <size_t... I>
+  void swap(const SoAReference& other, std::index_sequence<I...>) const
+  {
+    using std::swap;
+    (swap(std::get<I>(tuple()), std::get<I>(other.tuple())), ...);
+  }
+
+}; // SoAReference
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // SoAConstIterator: SoA const iterator class
 // ================
+// Random access iterator whose references are SoAReference proxies.
+// Each column is contiguous: data<I>() points to field I of the
+// element in its column.
+//
 template <typename index_t, typename... Args>
 class SoAConstIterator
 {
 public:
   using const_iterator = SoAConstIterator<index_t, Args...>;
   using SoA = SoABase<index_t, Args...>;
+  using iterator_category = std::random_access_iterator_tag;
+  using iterator_concept = std::random_access_iterator_tag;
+  using value_type = std::tuple<Args...>;
+  using difference_type = std::ptrdiff_t;
+  using reference = SoAReference<const Args...>;
 
   SoAConstIterator() = default;
 
@@ -179,6 +372,12 @@ public:
     return const_cast<SoA*>(_soa)->template get<I>(_index);
   }
 
+  template <size_t I>
+  const auto* data() const
+  {
+    return _soa->template data<I>() + _index;
+  }
+
   auto tuple() const
   {
     return _soa->tuple(_index);
@@ -189,6 +388,16 @@ public:
     return _index;
   }
 
+  reference operator *() const
+  {
+    return element<reference>(std::index_sequence_for<Args...>{});
+  }
+
+  reference operator [](difference_type n) const
+  {
+    return *(*this + n);
+  }
+
   const_iterator& operator ++()
   {
     ++_index;
@@ -217,6 +426,38 @@ public:
     return temp;
   }
 
+  const_iterator& operator +=(difference_type n)
+  {
+    _index = index_t(_index + n);
+    return *this;
+  }
+
+  const_iterator& operator -=(difference_type n)
+  {
+    _index = index_t(_index - n);
+    return *this;
+  }
+
+  const_iterator operator +(difference_type n) const
+  {
+    return const_iterator{*this} += n;
+  }
+
+  const_iterator operator -(difference_type n) const
+  {
+    return const_iterator{*this} -= n;
+  }
+
+  friend const_iterator operator +(difference_type n, const const_iterator& i)
+  {
+    return i + n;
+  }
+
+  difference_type operator -(const const_iterator& other) const
+  {
+    return difference_type(_index) - difference_type(other._index);
+  }
+
   bool operator ==(const const_iterator& other) const
   {
     return _soa == other._soa && _index == other._index;
@@ -227,10 +468,33 @@ public:
     return !operator ==(other);
   }
 
+  auto operator <=>(const const_iterator& other) const
+  {
+    return _index <=> other._index;
+  }
+
+  // Copies the fields of the element, which cannot be moved out
+  friend value_type iter_move(const const_iterator& i)
+  {
+    return i.template element<value_type>(std::index_sequence_for<Args...>{});
+  }
+
 protected:
   SoA* _soa{};
   index_t _index{};
 
+  template <typename R, size_t... I>
+  R element(std::index_sequence<I...>) const
+  {
+    return R{_soa->template get<I>(_index)...};
+  }
+
+  template <size_t... I>
+  value_type moveElement(std::index_sequence<I...>) const
+  {
+    return value_type{std::move(_soa->template get<I>(_index))...};
+  }
+
 }; // SoAConstIterator
 
 
@@ -245,6 +509,9 @@ public:
   using const_iterator = SoAConstIterator<index_t, Args...>;
   using iterator = SoAIterator<index_t,Args...>;
   using SoA = SoABase<index_t, Args...>;
+  using value_type = std::tuple<Args...>;
+  using difference_type = std::ptrdiff_t;
+  using reference = SoAReference<Args...>;
 
   SoAIterator() = default;
 
@@ -260,6 +527,12 @@ public:
     return this->_soa->template get<I>(this->_index);
   }
 
+  template <size_t I>
+  auto* data() const
+  {
+    return this->_soa->template data<I>() + this->_index;
+  }
+
   void set(const Args&... args)
   {
     return this->_soa->set(this->_index, args...);
@@ -270,6 +543,16 @@ public:
     return this->_soa->setTuple(this->_index, t);
   }
 
+  reference operator *() const
+  {
+    return this->template element<reference>(std::index_sequence_for<Args...>{});
+  }
+
+  reference operator [](difference_type n) const
+  {
+    return *(*this + n);
+  }
+
   iterator& operator ++()
   {
     ++*((const_iterator*)this);
@@ -298,6 +581,44 @@ public:
     return temp;
   }
 
+  iterator& operator +=(difference_type n)
+  {
+    *((const_iterator*)this) += n;
+    return *this;
+  }
+
+  iterator& operator -=(difference_type n)
+  {
+    *((const_iterator*)this) -= n;
+    return *this;
+  }
+
+  iterator operator +(difference_type n) const
+  {
+    return iterator{*this} += n;
+  }
+
+  iterator operator -(difference_type n) const
+  {
+    return iterator{*this} -= n;
+  }
+
+  friend iterator operator +(difference_type n, const iterator& i)
+  {
+    return i + n;
+  }
+
+  difference_type operator -(const const_iterator& other) const
+  {
+    return const_iterator::operator -(other);
+  }
+
+  // Moves the fields of the element out
+  friend value_type iter_move(const iterator& i)
+  {
+    return i.moveElement(std::index_sequence_for<Args...>{});
+  }
+
 }; // SoAIterator
 
 
@@ -383,6 +704,15 @@ protected:
 //
 // SoA: structure of arrays class
 // ===
+// If Allocator is a block allocator aligned for every field type, the
+// columns are carved out of a single block, each column padded to the
+// block alignment, so an SoA costs one allocation and one free, and
+// reallocate reuses the block when it is not too large.
+// The SoA grows like a vector: reserve, resize, push_back and
+// emplace_back keep the elements, moving them to larger columns when
+// needed, with memcpy for trivially copyable fields. The capacity is
+// doubled as the SoA grows. All elements up to the capacity are
+// constructed, so the columns can be read up to it.
 template <typename Allocator, typename index_t, typename... Args>
 class SoA: public SoABase<index_t, Args...>
 {
@@ -391,22 +721,30 @@ public:
   using type = SoA<Allocator, index_t, Args...>;
   using const_iterator = SoAConstIterator<index_t, Args...>;
   using iterator = SoAIterator<index_t, Args...>;
+  using value_type = typename Base::tuple_type;
+  using reference = typename iterator::reference;
+  using const_reference = typename const_iterator::reference;
+  using size_type = index_t;
+  using difference_type = std::ptrdiff_t;
+
+  // Whether the columns are carved out of a single block
+  static constexpr bool arena = soa::IsArenaAllocator<Allocator, Args...>;
 
   ~SoA()
   {
-    if (this->_size != 0)
-      this->_arrays.template free<Allocator>();
+    if (_capacity != 0)
+      freeArrays(this->_arrays, _capacity);
   }
 
   SoA()
   {
-    this->_size = 0;
+    this->_size = _capacity = 0;
   }
 
   SoA(index_t size)
   {
-    if ((this->_size = size) != 0)
-      this->_arrays.template allocate<Allocator>((size_t)size);
+    if ((this->_size = _capacity = size) != 0)
+      allocateArrays(size);
   }
 
   SoA(const type&) = delete;
@@ -416,7 +754,8 @@ public:
   {
     this->_size = other._size;
     this->_arrays = other._arrays;
-    other._size = 0;
+    _capacity = other._capacity;
+    other._size = other._capacity = 0;
   }
 
   type& operator =(type&& other) noexcept
@@ -426,21 +765,102 @@ public:
       this->~SoA();
       this->_size = other._size;
       this->_arrays = other._arrays;
-      other._size = 0;
+      _capacity = other._capacity;
+      other._size = other._capacity = 0;
     }
     return *this;
   }
 
+  auto capacity() const
+  {
+    return _capacity;
+  }
+
+  auto empty() const
+  {
+    return this->_size == 0;
+  }
+
+  // Resizes the SoA to size, discarding its elements
   bool reallocate(index_t size)
   {
     if (size == this->_size)
       return false;
+    if constexpr (arena)
+    {
+      // A block at most twice as large as needed is reused
+      auto n = blockSize(size);
+
+      if (n != 0 && n <= blockSize(_capacity) && 2 * n >= blockSize(_capacity))
+      {
+        this->_arrays.destroy((size_t)_capacity);
+        this->_arrays.carve((char*)this->_arrays.data, (size_t)size, alignment);
+        this->_size = _capacity = size;
+        return true;
+      }
+    }
     this->~SoA();
-    if ((this->_size = size) != 0)
-      this->_arrays.template allocate<Allocator>((size_t)size);
+    if ((this->_size = _capacity = size) != 0)
+      allocateArrays(size);
     return true;
   }
 
+  void reserve(index_t capacity)
+  {
+    if (capacity > _capacity)
+      setCapacity(capacity);
+  }
+
+  // Resizes the SoA to size, keeping its first elements; new elements
+  // are value-initialized
+  void resize(index_t size)
+  {
+    if (size > _capacity)
+      setCapacity(grownCapacity(size));
+    for (auto i = this->_size; i < size; ++i)
+      this->_arrays.set(i, typename Base::tuple_type{});
+    this->_size = size;
+  }
+
+  void push_back(const typename Base::tuple_type& t)
+  {
+    if (this->_size == _capacity)
+      setCapacity(grownCapacity(this->_size + 1));
+    this->_arrays.set(this->_size++, t);
+  }
+
+  // Appends an element whose fields are made from values, one value
+  // per field, and returns its index
+  template <typename... Values>
+  index_t emplace_back(Values&&... values)
+  {
+    static_assert(sizeof...(Values) == sizeof...(Args),
+      "SoA: one value per field expected");
+    if (this->_size == _capacity)
+      setCapacity(grownCapacity(this->_size + 1));
+    this->_arrays.emplace(this->_size, std::forward<Values>(values)...);
+    return this->_size++;
+  }
+
+  void shrink_to_fit()
+  {
+    if (_capacity != this->_size)
+      setCapacity(this->_size);
+  }
+
+  // Moves element order[i] to position i, for all i
+  void permute(const index_t* order)
+  {
+    if (this->_size == 0)
+      return;
+
+    auto arrays = this->_arrays;
+
+    allocateArrays(_capacity);
+    arrays.permute(this->_arrays, order, (size_t)this->_size);
+    freeArrays(arrays, _capacity);
+  }
+
   auto cbegin() const
   {
     return const_iterator{this, 0};
@@ -471,6 +891,75 @@ public:
     return iterator{this, this->_size};
   }
 
+private:
+  using Arrays = soa::Arrays<index_t, Args...>;
+
+  // Number of elements of every column, all of them constructed
+  index_t _capacity;
+
+  static constexpr size_t alignment = []()
+  {
+    if constexpr (arena)
+      return (size_t)Allocator::alignment;
+    else
+      return (size_t)0;
+  }();
+
+  static constexpr size_t blockSize(index_t capacity)
+  {
+    return Arrays::blockSize((size_t)capacity, alignment);
+  }
+
+  // Geometric growth to at least size elements
+  index_t grownCapacity(index_t size) const
+  {
+    constexpr auto max = std::numeric_limits<index_t>::max();
+    auto capacity = _capacity > max / 2 ? max : 2 * _capacity;
+
+    return std::max(capacity, size);
+  }
+
+  void allocateArrays(index_t capacity)
+  {
+    if constexpr (arena)
+    {
+      auto block = Allocator::allocateBlock(blockSize(capacity));
+      this->_arrays.carve(static_cast<char*>(block), (size_t)capacity, alignment);
+    }
+    else
+      this->_arrays.template allocate<Allocator>((size_t)capacity);
+  }
+
+  void freeArrays(Arrays& arrays, index_t capacity)
+  {
+    if constexpr (arena)
+    {
+      arrays.destroy((size_t)capacity);
+      Allocator::freeBlock(arrays.data);
+    }
+    else
+      arrays.template free<Allocator>();
+  }
+
+  // Moves the elements to new columns of capacity elements, which may
+  // drop the last ones
+  void setCapacity(index_t capacity)
+  {
+    auto arrays = this->_arrays;
+    auto size = std::min(this->_size, capacity);
+
+    if (capacity != 0)
+      allocateArrays(capacity);
+    if (_capacity != 0)
+    {
+      if (size != 0)
+        arrays.move(this->_arrays, (size_t)size);
+      freeArrays(arrays, _capacity);
+    }
+    this->_size = size;
+    _capacity = capacity;
+  }
+
 }; // SoA
 
 namespace soa
@@ -513,6 +1002,73 @@ setTuple(SoA& soa, typename SoA::index_type i, typename SoA::tuple_type& t)
 
 } // end namespace soa
 
+namespace soa
+{ // begin namespace soa
+
+constexpr size_t cacheLineSize = 64;
+
+// Least number of elements whose fields fill whole cache lines in
+// every column
+template <typename... Args>
+constexpr size_t
+cacheLineElements()
+{
+  size_t n = 1;
+
+  ((n = std::lcm(n, cacheLineSize / std::gcd(cacheLineSize, sizeof(Args)))), ...);
+  return n;
+}
+
+} // end namespace soa
+
+//
+// Calls f(i) for every element i of soa on all threads. The elements
+// are split into chunks of grain elements, rounded up so that chunks
+// start on cache lines of every column when the columns do (see
+// AlignedSoAAllocator), and the chunks are balanced among the threads
+// by work stealing (see parallelForChunks()).
+//
+template <typename index_t, typename... Args, typename F>
+void
+parallelFor(const SoABase<index_t, Args...>& soa, size_t grain, F&& f)
+{
+  constexpr auto m = soa::cacheLineElements<Args...>();
+
+  grain = (std::max<size_t>(grain, 1) + m - 1) / m * m;
+  parallelForChunks(soa.size(), grain, [&f](size_t b, size_t e)
+  {
+    for (auto i = index_t(b); i < e; ++i)
+      f(i);
+  });
+}
+
+//
+// Assigns f(in[i]) to out[i] for every element i on all threads, like
+// parallelFor(). f takes an SoA reference to an element of in and
+// returns a value assignable to an element of out, such as a tuple.
+//
+template <typename index_t, typename... In, typename A, typename... Out, typename F>
+void
+transform(const SoABase<index_t, In...>& in,
+  SoA<A, index_t, Out...>& out,
+  size_t grain,
+  F&& f)
+{
+  constexpr auto m = soa::cacheLineElements<In..., Out...>();
+
+  assert(in.size() == out.size());
+  grain = (std::max<size_t>(grain, 1) + m - 1) / m * m;
+
+  SoAConstIterator<index_t, In...> source{&in, 0};
+  SoAIterator<index_t, Out...> target{&out, 0};
+
+  parallelForChunks(out.size(), grain, [&](size_t b, size_t e)
+  {
+    for (auto i = b; i < e; ++i)
+      target[i] = f(source[i]);
+  });
+}
+
 } // end namespace tcii::cg
 
 #endif // __SoA_h
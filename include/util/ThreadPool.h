@@ -0,0 +1,140 @@
+#ifndef __ThreadPool_h
+#define __ThreadPool_h
+
+// OVERVIEW: ThreadPool.h
+// ========
+// Class definition for work-stealing thread pool.
+//
+// Last revision: 17/10/2026
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// ThreadPool: work-stealing thread pool
+// ==========
+// A job is a range of calls f(k), k in [0, n). A thread that takes a
+// range of calls pushes its upper half onto its own queue until one
+// call is left, and runs it. Idle threads take ranges from the back
+// of their own queue and steal from the front of the queues of the
+// other threads, that is, the largest ranges pushed. Threads outside
+// the pool share one queue. The thread that runs a job helps with the
+// queued ranges of the job, and of the jobs started by its calls, until
+// the job is done, so jobs can be nested. Ranges of other jobs are left
+// to other threads: a call holding a lock while it runs a job is never
+// reentered on its thread by a sibling call that takes the same lock.
+//
+class ThreadPool
+{
+public:
+  // Pool used by parallelRun(), with threadCount() - 1 workers
+  static ThreadPool& instance();
+
+  ThreadPool(unsigned workerCount);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator =(const ThreadPool&) = delete;
+
+  auto workerCount() const
+  {
+    return unsigned(_workers.size());
+  }
+
+  //
+  // Calls f(k) for k in [0, n) on the calling thread and the workers,
+  // and returns when all calls have finished. The first exception
+  // thrown by a call is rethrown then.
+  //
+  template <typename F>
+  void run(size_t n, F&& f)
+  {
+    using Function = std::remove_reference_t<F>;
+
+    Job job{[](void* f, size_t k)
+      {
+        (*static_cast<Function*>(f))(k);
+      },
+      (void*)&f,
+      n};
+
+    run(job);
+  }
+
+private:
+  struct Job
+  {
+    void (*call)(void*, size_t);
+    void* f;
+    std::atomic<size_t> pending;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    // Job one of whose calls ran this job, if any
+    const Job* parent{};
+
+    // True if this is job or was started, directly or not, by its calls
+    bool nestedIn(const Job* job) const
+    {
+      for (auto j = this; j != nullptr; j = j->parent)
+        if (j == job)
+          return true;
+      return false;
+    }
+
+  }; // Job
+
+  struct Range
+  {
+    Job* job;
+    size_t begin;
+    size_t end;
+
+  }; // Range
+
+  // Queues of different threads do not share cache lines
+  struct alignas(64) Queue
+  {
+    std::mutex lock;
+    std::deque<Range> ranges;
+
+  }; // Queue
+
+  std::vector<std::thread> _workers;
+  // One queue per worker, then the queue of the other threads
+  std::unique_ptr<Queue[]> _queues;
+  std::atomic<size_t> _queued{0};
+  std::atomic<unsigned> _sleeping{0};
+  std::mutex _sleepLock;
+  std::condition_variable _wakeup;
+  bool _stop{false};
+
+  // Job whose call is running on this thread, if any
+  static thread_local const Job* _currentJob;
+
+  unsigned queueIndex() const;
+
+  void push(const Range& range);
+  bool take(Range& range, const Job* job = nullptr);
+  void execute(Range range);
+  void run(Job& job);
+  void work(unsigned index);
+
+}; // ThreadPool
+
+} // end namespace tcii::cg
+
+#endif // __ThreadPool_h
@@ -0,0 +1,152 @@
+// OVERVIEW: AmbientOcclusion.cpp
+// ========
+// Source file for per-triangle ambient occlusion.
+//
+// Last revision: 17/10/2026
+
+#include "AmbientOcclusion.h"
+#include "util/Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+using index_t = BVH::index_t;
+using vec3 = BVH::vec3;
+
+// Number of triangles taken by a thread at a time
+constexpr index_t tileSize = 64;
+
+// Ray origins are moved off the surface by this fraction of the size
+// of the mesh bounds, so that rays do not hit their own triangle
+constexpr float originOffset = 1e-5f;
+
+//
+// Random: SplitMix64 generator
+// ======
+class Random
+{
+public:
+  Random(uint64_t seed):
+    _state{seed}
+  {
+    // do nothing
+  }
+
+  uint64_t next()
+  {
+    auto z = _state += 0x9e3779b97f4a7c15;
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [0, 1)
+  float uniform()
+  {
+    return float(next() >> 40) * 0x1p-24f;
+  }
+
+private:
+  uint64_t _state;
+
+}; // Random
+
+// Orthonormal basis (Duff et al., Building an orthonormal basis,
+// revisited, 2017)
+inline void
+basis(const vec3& n, vec3& b1, vec3& b2)
+{
+  auto s = std::copysign(1.0f, n.z);
+  auto a = -1 / (s + n.z);
+  auto b = n.x * n.y * a;
+
+  b1 = {1 + s * n.x * n.x * a, s * b, -s * n.x};
+  b2 = {b, s + n.y * n.y * a, -n.y};
+}
+
+} // end namespace
+
+size_t
+ambientOcclusion(const BVH& bvh,
+  unsigned rayCount,
+  float* occlusion,
+  float maxDistance,
+  uint64_t seed)
+{
+  auto& data = bvh.mesh().data();
+  auto nt = data.triangleCount();
+  auto vertices = data.vertices();
+  auto& bounds = bvh.bounds();
+  auto offset = originOffset * (bounds.max() - bounds.min()).length();
+  auto tileCount = (nt + tileSize - 1) / tileSize;
+  std::atomic<index_t> nextTile{0};
+  std::atomic<size_t> totalRays{0};
+
+  parallelRun(std::min(threadCount(), tileCount), [&](unsigned)
+  {
+    size_t castRays = 0;
+
+    for (index_t tile; (tile = nextTile++) < tileCount;)
+    {
+      auto end = std::min(nt, (tile + 1) * tileSize);
+
+      for (auto t = tile * tileSize; t < end; ++t)
+      {
+        auto& triangle = data.triangle(t);
+        auto v0 = vertices[triangle.i];
+        auto e1 = vertices[triangle.j] - v0;
+        auto e2 = vertices[triangle.k] - v0;
+        auto n = cross(e1, e2);
+        auto length = n.length();
+
+        occlusion[t] = 0;
+        if (!(length > 0) || rayCount == 0)
+          continue;
+        n = (1 / length) * n;
+
+        vec3 b1, b2;
+
+        basis(n, b1, b2);
+
+        // Cosine-distributed directions over uniformly distributed
+        // points of the triangle. The directions spread over the whole
+        // hemisphere, so packets do not pay off; rays are traced alone
+        Random random{seed ^ (uint64_t(t) * 0xd1b54a32d192ed03)};
+        unsigned occluded = 0;
+        BVH::Ray ray;
+
+        ray.tMax = maxDistance;
+        for (unsigned i = 0; i < rayCount; ++i)
+        {
+          auto s = std::sqrt(random.uniform());
+          auto v = random.uniform();
+          auto p = v0 + (s * (1 - v)) * e1 + (s * v) * e2;
+          auto r = std::sqrt(random.uniform());
+          auto phi = 2 * std::numbers::pi_v<float> * random.uniform();
+          auto x = r * std::cos(phi);
+          auto y = r * std::sin(phi);
+          auto z = std::sqrt(std::max(0.0f, 1 - r * r));
+
+          ray.origin = p + offset * n;
+          ray.direction = x * b1 + y * b2 + z * n;
+          occluded += bvh.occluded(ray);
+        }
+        occlusion[t] = float(occluded) / rayCount;
+        castRays += rayCount;
+      }
+    }
+    totalRays += castRays;
+  });
+  return totalRays;
+}
+
+} // end namespace tcii::cg
@@ -0,0 +1,708 @@
+// OVERVIEW: BVH.cpp
+// ========
+// Source file for bounding volume hierarchy.
+//
+// Last revision: 17/10/2026
+
+#include "BVH.h"
+#include "util/Parallel.h"
+#include <algorithm>
+#include <atomic>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+using index_t = BVH::index_t;
+using vec3 = BVH::vec3;
+using Bounds = BVH::Bounds;
+using Node = BVH::Node;
+
+// The upper levels are split into about this many subtrees, but not
+// into subtrees smaller than minTrianglesPerSubtree
+constexpr index_t subtreeCount = 64;
+constexpr index_t minTrianglesPerSubtree = 1 << 12;
+
+constexpr unsigned binCount = 16;
+constexpr index_t maxLeafSize = 8;
+
+// Cost of visiting a node relative to intersecting a triangle
+constexpr float traversalCost = 1;
+
+// Below this depth, nodes are split at the median, so that the tree
+// depth (and the traversal stack) stays bounded
+constexpr unsigned maxSAHDepth = 64;
+constexpr unsigned stackSize = 128;
+
+//
+// Box: axis-aligned box used by the builder. Bounds3::inflate() branches
+// on every coordinate, which dominates the binning loops; a box grows
+// with branchless min/max instead.
+//
+struct Box
+{
+  vec3 min{+BVH::infinity, +BVH::infinity, +BVH::infinity};
+  vec3 max{-BVH::infinity, -BVH::infinity, -BVH::infinity};
+
+  void inflate(const vec3& p)
+  {
+    inflate(p, p);
+  }
+
+  // Also correct if b is empty
+  void inflate(const Box& b)
+  {
+    inflate(b.min, b.max);
+  }
+
+  void inflate(const vec3& p, const vec3& q)
+  {
+    min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+    max = {std::max(max.x, q.x), std::max(max.y, q.y), std::max(max.z, q.z)};
+  }
+
+  auto area() const
+  {
+    auto d = max - min;
+    return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+
+}; // Box
+
+inline auto
+reciprocal(const vec3& v)
+{
+  return vec3{1 / v.x, 1 / v.y, 1 / v.z};
+}
+
+// Slab test of a ray against the bounds of a node
+inline bool
+intersectBox(const Node& node,
+  const vec3& o,
+  const vec3& invD,
+  float tMin,
+  float tMax)
+{
+  auto x0 = (node.min.x - o.x) * invD.x;
+  auto x1 = (node.max.x - o.x) * invD.x;
+  auto y0 = (node.min.y - o.y) * invD.y;
+  auto y1 = (node.max.y - o.y) * invD.y;
+  auto z0 = (node.min.z - o.z) * invD.z;
+  auto z1 = (node.max.z - o.z) * invD.z;
+
+  tMin = std::max(std::max(std::min(x0, x1), std::min(y0, y1)),
+    std::max(std::min(z0, z1), tMin));
+  tMax = std::min(std::min(std::max(x0, x1), std::max(y0, y1)),
+    std::min(std::max(z0, z1), tMax));
+  return tMin <= tMax;
+}
+
+// Moller-Trumbore; both sides of the triangle are hit
+template <typename Triangle>
+inline bool
+intersectTriangle(const Triangle& triangle,
+  const vec3& o,
+  const vec3& d,
+  float tMin,
+  float tMax,
+  BVH::Hit& hit)
+{
+  auto p = cross(d, triangle.e2);
+  auto det = dot(triangle.e1, p);
+
+  if (det == 0)
+    return false;
+
+  auto invDet = 1 / det;
+  auto s = o - triangle.v0;
+  auto u = dot(s, p) * invDet;
+
+  if (u < 0 || u > 1)
+    return false;
+
+  auto q = cross(s, triangle.e1);
+  auto v = dot(d, q) * invDet;
+
+  if (v < 0 || u + v > 1)
+    return false;
+
+  auto t = dot(triangle.e2, q) * invDet;
+
+  if (!(t > tMin && t < tMax))
+    return false;
+  hit.t = t;
+  hit.u = u;
+  hit.v = v;
+  return true;
+}
+
+inline bool
+overlaps(const Bounds& a, const vec3& min, const vec3& max)
+{
+  return a.min().x <= max.x && a.max().x >= min.x &&
+    a.min().y <= max.y && a.max().y >= min.y &&
+    a.min().z <= max.z && a.max().z >= min.z;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Builder: binned SAH BVH builder
+// =======
+class Builder
+{
+public:
+  Builder(const std::vector<Box>& boxes,
+    const std::vector<vec3>& centroids,
+    index_t* indices):
+    _boxes{boxes.data()},
+    _centroids{centroids.data()},
+    _indices{indices}
+  {
+    // do nothing
+  }
+
+  // Sets the bounds of node and partitions the triangles [begin, end)
+  // of the node in two. Returns the split position, or end if the node
+  // should be a leaf
+  index_t split(Node& node, index_t begin, index_t end, unsigned depth) const;
+
+  // Builds the subtree rooted at nodes[n]
+  void build(std::vector<Node>& nodes,
+    index_t n,
+    index_t begin,
+    index_t end,
+    unsigned depth) const;
+
+private:
+  struct Bin
+  {
+    Box bounds;
+    index_t count{};
+
+  }; // Bin
+
+  const Box* _boxes;
+  const vec3* _centroids;
+  index_t* _indices;
+
+  index_t splitMedian(index_t begin, index_t end, int axis) const;
+
+}; // Builder
+
+index_t
+Builder::splitMedian(index_t begin, index_t end, int axis) const
+{
+  auto mid = begin + (end - begin) / 2;
+
+  std::nth_element(_indices + begin,
+    _indices + mid,
+    _indices + end,
+    [this, axis](index_t a, index_t b)
+    {
+      return _centroids[a][axis] < _centroids[b][axis];
+    });
+  return mid;
+}
+
+index_t
+Builder::split(Node& node, index_t begin, index_t end, unsigned depth) const
+{
+  Box bounds;
+  Box centroidBounds;
+
+  for (auto i = begin; i < end; ++i)
+  {
+    bounds.inflate(_boxes[_indices[i]]);
+    centroidBounds.inflate(_centroids[_indices[i]]);
+  }
+  node.min = bounds.min;
+  node.max = bounds.max;
+  node.count = node.axis = 0;
+
+  auto n = end - begin;
+
+  if (n <= 1)
+    return end;
+
+  auto extent = centroidBounds.max - centroidBounds.min;
+  int longest = extent.x > extent.y ?
+    (extent.x > extent.z ? 0 : 2) :
+    (extent.y > extent.z ? 1 : 2);
+
+  if (depth >= maxSAHDepth)
+  {
+    node.axis = longest;
+    return splitMedian(begin, end, longest);
+  }
+
+  // Sweep the bins of each axis from both sides; splitting after bin s
+  // costs area(left) * count(left) + area(right) * count(right)
+  auto bestCost = BVH::infinity;
+  int bestAxis = -1;
+  unsigned bestBin = 0;
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (!(extent[axis] > 0))
+      continue;
+
+    Bin bins[binCount];
+    auto min = centroidBounds.min[axis];
+    auto scale = binCount / extent[axis];
+
+    for (auto i = begin; i < end; ++i)
+    {
+      auto t = _indices[i];
+      auto b = std::min(binCount - 1,
+        unsigned((_centroids[t][axis] - min) * scale));
+
+      bins[b].bounds.inflate(_boxes[t]);
+      ++bins[b].count;
+    }
+
+    float rightCost[binCount];
+    Box right;
+    index_t rightCount = 0;
+
+    for (auto s = binCount - 1; s > 0; --s)
+    {
+      right.inflate(bins[s].bounds);
+      rightCount += bins[s].count;
+      rightCost[s] = rightCount ? right.area() * rightCount : 0;
+    }
+
+    Box left;
+    index_t leftCount = 0;
+
+    for (unsigned s = 1; s < binCount; ++s)
+    {
+      left.inflate(bins[s - 1].bounds);
+      leftCount += bins[s - 1].count;
+      if (leftCount == 0 || leftCount == n)
+        continue;
+
+      auto cost = left.area() * leftCount + rightCost[s];
+
+      if (cost < bestCost)
+      {
+        bestCost = cost;
+        bestAxis = axis;
+        bestBin = s;
+      }
+    }
+  }
+  if (bestAxis < 0)
+  {
+    // All centroids coincide
+    if (n <= maxLeafSize)
+      return end;
+    return splitMedian(begin, end, longest);
+  }
+
+  auto nodeArea = bounds.area();
+
+  if (n <= maxLeafSize && traversalCost * nodeArea + bestCost >= n * nodeArea)
+    return end;
+  node.axis = bestAxis;
+
+  auto min = centroidBounds.min[bestAxis];
+  auto scale = binCount / extent[bestAxis];
+  auto mid = std::partition(_indices + begin,
+    _indices + end,
+    [&](index_t t)
+    {
+      auto b = std::min(binCount - 1,
+        unsigned((_centroids[t][bestAxis] - min) * scale));
+
+      return b < bestBin;
+    });
+  return index_t(mid - _indices);
+}
+
+void
+Builder::build(std::vector<Node>& nodes,
+  index_t n,
+  index_t begin,
+  index_t end,
+  unsigned depth) const
+{
+  auto mid = split(nodes[n], begin, end, depth);
+
+  if (mid == end)
+  {
+    nodes[n].offset = begin;
+    nodes[n].count = uint16_t(end - begin);
+    return;
+  }
+
+  auto c = (index_t)nodes.size();
+
+  nodes[n].offset = c;
+  nodes.resize(c + 2);
+  build(nodes, c, begin, mid, depth + 1);
+  build(nodes, c + 1, mid, end, depth + 1);
+}
+
+} // end namespace
+
+BVH::BVH(const TriangleMesh& mesh):
+  _mesh{&mesh}
+{
+  auto& data = mesh.data();
+  auto nt = data.triangleCount();
+  auto vertices = data.vertices();
+  std::vector<Box> boxes(nt);
+  std::vector<vec3> centroids(nt);
+
+  _indices.resize(nt);
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = (index_t)b; i < e; ++i)
+    {
+      auto& t = data.triangle(i);
+      vec3 p[]{vertices[t.i], vertices[t.j], vertices[t.k]};
+
+      for (auto& v : p)
+        boxes[i].inflate(v);
+      centroids[i] = (1.0f / 3) * (p[0] + p[1] + p[2]);
+      _indices[i] = i;
+    }
+  });
+
+  // Split the upper levels serially into subtrees, then build the
+  // subtrees in parallel and splice them into the node array in a fixed
+  // order. Neither the split into subtrees nor the splice depends on
+  // the number of threads, so neither does the node array
+  struct Subtree
+  {
+    index_t node;
+    index_t begin;
+    index_t end;
+    unsigned depth;
+    std::vector<Node> nodes;
+
+  }; // Subtree
+
+  Builder builder{boxes, centroids, _indices.data()};
+  auto grain = std::max(nt / subtreeCount, minTrianglesPerSubtree);
+  std::vector<Subtree> subtrees;
+  auto top = [&](auto& self, index_t n, index_t b, index_t e, unsigned depth)
+  {
+    if (e - b <= grain)
+    {
+      subtrees.push_back({n, b, e, depth});
+      return;
+    }
+
+    auto mid = builder.split(_nodes[n], b, e, depth);
+
+    if (mid == e)
+    {
+      _nodes[n].offset = b;
+      _nodes[n].count = uint16_t(e - b);
+      return;
+    }
+
+    auto c = (index_t)_nodes.size();
+
+    _nodes[n].offset = c;
+    _nodes.resize(c + 2);
+    self(self, c, b, mid, depth + 1);
+    self(self, c + 1, mid, e, depth + 1);
+  };
+
+  _nodes.resize(1);
+  if (nt != 0)
+    top(top, 0, 0, nt, 0);
+
+  std::atomic<size_t> next{0};
+
+  parallelRun(std::min<size_t>(threadCount(), subtrees.size()), [&](unsigned)
+  {
+    for (size_t i; (i = next++) < subtrees.size();)
+    {
+      auto& s = subtrees[i];
+
+      s.nodes.resize(1);
+      builder.build(s.nodes, 0, s.begin, s.end, s.depth);
+    }
+  });
+  for (auto& s : subtrees)
+  {
+    // Local node 0 replaces the placeholder; node i > 0 goes to base + i
+    auto base = (index_t)_nodes.size() - 1;
+    auto remap = [base](Node node)
+    {
+      if (!node.isLeaf())
+        node.offset += base;
+      return node;
+    };
+
+    _nodes[s.node] = remap(s.nodes[0]);
+    for (size_t i = 1; i < s.nodes.size(); ++i)
+      _nodes.push_back(remap(s.nodes[i]));
+  }
+  if (nt != 0)
+  {
+    _bounds.inflate(_nodes[0].min);
+    _bounds.inflate(_nodes[0].max);
+  }
+
+  _triangles.resize(nt);
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = b; i < e; ++i)
+    {
+      auto& t = data.triangle(_indices[i]);
+      auto v0 = vertices[t.i];
+
+      _triangles[i] = {v0, vertices[t.j] - v0, vertices[t.k] - v0};
+    }
+  });
+}
+
+template <bool anyHit>
+bool
+BVH::trace(const Ray& ray, Hit* hit) const
+{
+  if (_triangles.empty())
+    return false;
+
+  auto invD = reciprocal(ray.direction);
+  auto tMax = ray.tMax;
+  bool found = false;
+  index_t stack[stackSize];
+  unsigned top = 0;
+
+  stack[top++] = 0;
+  while (top != 0)
+  {
+    auto& node = _nodes[stack[--top]];
+
+    if (!intersectBox(node, ray.origin, invD, ray.tMin, tMax))
+      continue;
+    if (node.isLeaf())
+    {
+      Hit h;
+
+      for (auto i = node.offset, e = i + node.count; i < e; ++i)
+        if (intersectTriangle(_triangles[i],
+          ray.origin,
+          ray.direction,
+          ray.tMin,
+          tMax,
+          h))
+        {
+          if constexpr (anyHit)
+            return true;
+          tMax = h.t;
+          h.triangle = _indices[i];
+          *hit = h;
+          found = true;
+        }
+      continue;
+    }
+
+    // Visit the child on the near side of the split first
+    auto nearFirst = ray.direction[node.axis] >= 0;
+
+    stack[top++] = node.offset + nearFirst;
+    stack[top++] = node.offset + !nearFirst;
+  }
+  return found;
+}
+
+bool
+BVH::intersect(const Ray& ray, Hit& hit) const
+{
+  return trace<false>(ray, &hit);
+}
+
+bool
+BVH::occluded(const Ray& ray) const
+{
+  return trace<true>(ray, nullptr);
+}
+
+void
+BVH::overlap(const Bounds& box, std::vector<index_t>& triangles) const
+{
+  if (_triangles.empty())
+    return;
+
+  index_t stack[stackSize];
+  unsigned top = 0;
+
+  stack[top++] = 0;
+  while (top != 0)
+  {
+    auto& node = _nodes[stack[--top]];
+
+    if (!overlaps(box, node.min, node.max))
+      continue;
+    if (!node.isLeaf())
+    {
+      stack[top++] = node.offset + 1;
+      stack[top++] = node.offset;
+      continue;
+    }
+    for (auto i = node.offset, e = i + node.count; i < e; ++i)
+    {
+      auto& t = _triangles[i];
+      Bounds b;
+
+      b.inflate(t.v0);
+      b.inflate(t.v0 + t.e1);
+      b.inflate(t.v0 + t.e2);
+      if (overlaps(box, b.min(), b.max()))
+        triangles.push_back(_indices[i]);
+    }
+  }
+}
+
+//
+// The rays of a packet are kept as arrays of lanes so the box test
+// loop over the lanes has no branches and can be vectorized. A node is
+// skipped when no active ray hits its box; any-hit rays are deactivated
+// as soon as they hit by emptying their interval.
+//
+template <bool anyHit>
+void
+BVH::tracePacket(const Ray* rays,
+  unsigned count,
+  Hit* hits,
+  bool* results) const
+{
+  float ox[packetSize], oy[packetSize], oz[packetSize];
+  float ix[packetSize], iy[packetSize], iz[packetSize];
+  float t0[packetSize], t1[packetSize];
+  bool mask[packetSize];
+
+  for (unsigned l = 0; l < packetSize; ++l)
+  {
+    if (l < count)
+    {
+      auto& r = rays[l];
+      auto invD = reciprocal(r.direction);
+
+      ox[l] = r.origin.x, oy[l] = r.origin.y, oz[l] = r.origin.z;
+      ix[l] = invD.x, iy[l] = invD.y, iz[l] = invD.z;
+      t0[l] = r.tMin;
+      t1[l] = r.tMax;
+      if constexpr (anyHit)
+        results[l] = false;
+      else
+        hits[l].triangle = noTriangle;
+    }
+    else
+    {
+      ox[l] = oy[l] = oz[l] = ix[l] = iy[l] = iz[l] = 0;
+      t0[l] = infinity;
+      t1[l] = -infinity;
+    }
+  }
+  if (_triangles.empty())
+    return;
+
+  index_t stack[stackSize];
+  unsigned top = 0;
+  unsigned active = count;
+
+  stack[top++] = 0;
+  while (top != 0 && active != 0)
+  {
+    auto& node = _nodes[stack[--top]];
+    bool any = false;
+
+    for (unsigned l = 0; l < packetSize; ++l)
+    {
+      auto x0 = (node.min.x - ox[l]) * ix[l];
+      auto x1 = (node.max.x - ox[l]) * ix[l];
+      auto y0 = (node.min.y - oy[l]) * iy[l];
+      auto y1 = (node.max.y - oy[l]) * iy[l];
+      auto z0 = (node.min.z - oz[l]) * iz[l];
+      auto z1 = (node.max.z - oz[l]) * iz[l];
+      auto tNear = std::max(std::max(std::min(x0, x1), std::min(y0, y1)),
+        std::max(std::min(z0, z1), t0[l]));
+      auto tFar = std::min(std::min(std::max(x0, x1), std::max(y0, y1)),
+        std::min(std::max(z0, z1), t1[l]));
+
+      mask[l] = tNear <= tFar;
+      any |= mask[l];
+    }
+    if (!any)
+      continue;
+    if (node.isLeaf())
+    {
+      for (unsigned l = 0; l < count; ++l)
+      {
+        if (!mask[l])
+          continue;
+
+        auto& r = rays[l];
+        Hit h;
+
+        for (auto i = node.offset, e = i + node.count; i < e; ++i)
+          if (intersectTriangle(_triangles[i],
+            r.origin,
+            r.direction,
+            t0[l],
+            t1[l],
+            h))
+          {
+            if constexpr (anyHit)
+            {
+              results[l] = true;
+              t0[l] = infinity;
+              t1[l] = -infinity;
+              --active;
+              break;
+            }
+            h.triangle = _indices[i];
+            hits[l] = h;
+            t1[l] = h.t;
+          }
+      }
+      continue;
+    }
+
+    // Order the children by the direction of the first active ray
+    unsigned l = 0;
+
+    while (!mask[l])
+      ++l;
+
+    float d[]{rays[l].direction.x, rays[l].direction.y, rays[l].direction.z};
+    auto nearFirst = d[node.axis] >= 0;
+
+    stack[top++] = node.offset + nearFirst;
+    stack[top++] = node.offset + !nearFirst;
+  }
+}
+
+void
+BVH::intersect(const Ray* rays, Hit* hits, size_t count) const
+{
+  for (size_t i = 0; i < count; i += packetSize)
+  {
+    auto n = (unsigned)std::min<size_t>(packetSize, count - i);
+
+    tracePacket<false>(rays + i, n, hits + i, nullptr);
+  }
+}
+
+void
+BVH::occluded(const Ray* rays, bool* results, size_t count) const
+{
+  for (size_t i = 0; i < count; i += packetSize)
+  {
+    auto n = (unsigned)std::min<size_t>(packetSize, count - i);
+
+    tracePacket<true>(rays + i, n, nullptr, results + i);
+  }
+}
+
+} // end namespace tcii::cg
@@ -0,0 +1,236 @@
+// OVERVIEW: Components.cpp
+// ========
+// Source file for connected component labelling.
+//
+// Last revision: 17/10/2026
+
+#include "Components.h"
+#include "util/Parallel.h"
+#include <atomic>
+#include <limits>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+using index_t = TriangleMesh::index_t;
+using vec3 = TriangleMesh::vec3;
+
+//
+// UnionFind: lock-free disjoint sets of vertices
+// =========
+// Roots are linked with compare-and-swap, always the greater root under
+// the lesser one, so the root of a set is its least element and does
+// not depend on the order of the unions. Finds halve the paths they
+// walk (Jayanti and Tarjan, A randomized concurrent algorithm for
+// disjoint set union, 2016, without the randomization).
+//
+class UnionFind
+{
+public:
+  UnionFind(index_t n):
+    _parents(n)
+  {
+    parallelFor(n, minVerticesPerBlock, [this](size_t b, size_t e, unsigned)
+    {
+      for (auto v = b; v < e; ++v)
+        _parents[v] = index_t(v);
+    });
+  }
+
+  index_t find(index_t v)
+  {
+    for (;;)
+    {
+      auto p = parent(v).load(std::memory_order_relaxed);
+
+      if (p == v)
+        return v;
+
+      auto g = parent(p).load(std::memory_order_relaxed);
+
+      if (p != g)
+        parent(v).compare_exchange_weak(p, g, std::memory_order_relaxed);
+      v = g;
+    }
+  }
+
+  void unite(index_t a, index_t b)
+  {
+    for (;;)
+    {
+      a = find(a);
+      b = find(b);
+      if (a == b)
+        return;
+      if (a < b)
+        std::swap(a, b);
+      if (parent(a).compare_exchange_strong(a, b, std::memory_order_relaxed))
+        return;
+    }
+  }
+
+  // Roots; valid once there are no more unions
+  auto& roots()
+  {
+    auto n = _parents.size();
+
+    parallelFor(n, minVerticesPerBlock, [this](size_t b, size_t e, unsigned)
+    {
+      for (auto v = index_t(b); v < e; ++v)
+        parent(v).store(find(v), std::memory_order_relaxed);
+    });
+    return _parents;
+  }
+
+private:
+  std::vector<index_t> _parents;
+
+  std::atomic_ref<index_t> parent(index_t v)
+  {
+    return std::atomic_ref<index_t>{_parents[v]};
+  }
+
+}; // UnionFind
+
+inline void
+atomicMin(float& x, float y)
+{
+  std::atomic_ref<float> a{x};
+
+  for (auto v = a.load(std::memory_order_relaxed);
+    y < v && !a.compare_exchange_weak(v, y, std::memory_order_relaxed);)
+    ;
+}
+
+inline void
+atomicMax(float& x, float y)
+{
+  std::atomic_ref<float> a{x};
+
+  for (auto v = a.load(std::memory_order_relaxed);
+    y > v && !a.compare_exchange_weak(v, y, std::memory_order_relaxed);)
+    ;
+}
+
+} // end namespace
+
+//
+// The triangle counts and bounds are accumulated by each thread over
+// runs of consecutive triangles in the same component, which is how
+// components usually lie in mesh files; a run is added to its
+// component with atomic operations when it ends. Sums of counts and
+// minima and maxima do not depend on the order of the additions.
+//
+MeshComponents
+connectedComponents(const TriangleMesh& mesh)
+{
+  auto& data = mesh.data();
+  auto nv = data.vertexCount();
+  auto nt = data.triangleCount();
+  auto triangles = data.triangles();
+  auto vertices = data.vertices();
+  UnionFind sets{nv};
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto t = b; t < e; ++t)
+    {
+      auto& triangle = triangles[t];
+
+      sets.unite(triangle.i, triangle.j);
+      sets.unite(triangle.i, triangle.k);
+    }
+  });
+
+  auto& roots = sets.roots();
+
+  // The components are the sets with triangles, numbered by a scan of
+  // the flags of their roots
+  std::vector<index_t> ids(nv);
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto t = b; t < e; ++t)
+    {
+      std::atomic_ref<index_t> flag{ids[roots[triangles[t].i]]};
+
+      if (flag.load(std::memory_order_relaxed) == 0)
+        flag.store(1, std::memory_order_relaxed);
+    }
+  });
+  parallelInclusiveScan(ids.data(), nv);
+
+  auto count = nv ? ids[nv - 1] : 0;
+  MeshComponents components;
+  std::vector<float> bounds(6 * size_t(count));
+
+  components.labels = MeshComponents::Labels::New(mesh);
+  components.triangleCounts.resize(count);
+  for (index_t c = 0; c < count; ++c)
+  {
+    constexpr auto inf = std::numeric_limits<float>::infinity();
+    auto box = bounds.data() + 6 * size_t(c);
+
+    box[0] = box[1] = box[2] = inf;
+    box[3] = box[4] = box[5] = -inf;
+  }
+
+  auto labels = components.labels->triangleAttributeData<0>();
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    auto run = ~index_t{};
+    index_t size = 0;
+    Bounds3f box;
+
+    auto flush = [&]()
+    {
+      if (size == 0)
+        return;
+      std::atomic_ref<index_t>{components.triangleCounts[run]}.fetch_add(size,
+        std::memory_order_relaxed);
+
+      auto p = bounds.data() + 6 * size_t(run);
+
+      for (int i = 0; i < 3; ++i)
+      {
+        atomicMin(p[i], box.min()[i]);
+        atomicMax(p[i + 3], box.max()[i]);
+      }
+      size = 0;
+      box = Bounds3f{};
+    };
+
+    for (auto t = b; t < e; ++t)
+    {
+      auto& triangle = triangles[t];
+      auto c = ids[roots[triangle.i]] - 1;
+
+      if (c != run)
+      {
+        flush();
+        run = c;
+      }
+      labels[t] = c;
+      ++size;
+      box.inflate(vertices[triangle.i]);
+      box.inflate(vertices[triangle.j]);
+      box.inflate(vertices[triangle.k]);
+    }
+    flush();
+  });
+  components.bounds.resize(count);
+  for (index_t c = 0; c < count; ++c)
+  {
+    auto p = bounds.data() + 6 * size_t(c);
+
+    components.bounds[c].inflate({p[0], p[1], p[2]});
+    components.bounds[c].inflate({p[3], p[4], p[5]});
+  }
+  return components;
+}
+
+} // end namespace tcii::cg
@@ -0,0 +1,54 @@
+// OVERVIEW: Lighting.cpp
+// ========
+// Source file for per-triangle lighting.
+//
+// Last revision: 17/10/2026
+
+#include "Lighting.h"
+#include "MeshKernels.h"
+#include "util/Parallel.h"
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+void
+lambert(const TriangleMesh& mesh,
+  const DirectionalLight* lights,
+  size_t lightCount,
+  float* brightness)
+{
+  auto& data = mesh.data();
+
+  assert(data.hasVertexNormals());
+
+  // The kernel takes unit directions followed by intensities
+  std::vector<float> l(4 * lightCount);
+
+  for (size_t j = 0; j < lightCount; ++j)
+  {
+    auto d = lights[j].direction.versor();
+
+    l[4 * j + 0] = d.x;
+    l[4 * j + 1] = d.y;
+    l[4 * j + 2] = d.z;
+    l[4 * j + 3] = lights[j].intensity;
+  }
+
+  auto normals = data.vertexNormals();
+  auto indices = &data.triangles().data()->i;
+
+  parallelFor(data.triangleCount(),
+    minTrianglesPerBlock,
+    [&](size_t b, size_t e, unsigned)
+    {
+      kernels::lambert(normals,
+        indices + 3 * b,
+        e - b,
+        l.data(),
+        lightCount,
+        brightness + b);
+    });
+}
+
+} // end namespace tcii::cg
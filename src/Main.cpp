@@ -4,8 +4,18 @@
 *
 * Prova 2 de Tópicos em Computação 2
 */
+#include "AmbientOcclusion.h"
+#include "Components.h"
+#include "Lighting.h"
 #include "MeshAttribute.h"
+#include "Meshlets.h"
+#include "OBJStream.h"
+#include "Simplification.h"
 #include "TriangleMesh.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
 
 using namespace tcii::cg;
 
@@ -14,6 +24,9 @@ using Weight = float;
 using Brightness = float;
 using Shadow = float;
 
+// Elements per chunk of the parallel attribute loops
+constexpr size_t grainSize = 1 << 12;
+
 auto applyColors(const ObjectPtr<MeshAttribute<void, void>>& base) {
 
   using VA = ElementAttribute<Color>;
@@ -22,16 +35,15 @@ auto applyColors(const ObjectPtr<MeshAttribute<void, void>>& base) {
 
   auto ma = MA::New(base->mesh());
 
-  auto nv = ma->mesh().data().vertexCount();
-  auto nt = ma->mesh().data().triangleCount();
-
-  for (decltype(nv) i = 0; i < nv; ++i)
+  parallelFor(ma->vertexAttributes(), grainSize, [&](auto i) {
     ma->setVertexAttributes(i, Color{0, 1, 0});
+  });
 
   ma->setVertexAttribute<0>(0, Color{0, 1, 1});
 
-  for (decltype(nt) i = 0; i < nt; ++i)
+  parallelFor(ma->triangleAttributes(), grainSize, [&](auto i) {
     ma->setTriangleAttributes(i, Color{0, 1, 0});
+  });
 
   ma->setTriangleAttribute<0>(0, Color{0, 1, 1});
 
@@ -47,32 +59,54 @@ auto addVertexWeights(const ObjectPtr<MeshAttribute<ElementAttribute<Color>, Ele
 
   auto ma = MA::New(base->mesh());
 
-  auto nv = ma->mesh().data().vertexCount();
-
-  for (decltype(nv) i = 0; i < nv; ++i) {
+  parallelFor(ma->vertexAttributes(), grainSize, [&](auto i) {
 
     const auto& vertex = ma->mesh().data().vertex(i);
 
     ma->setVertexAttributes(i, base->vertexAttribute<0>(i), vertex.y);
 
-  }
+  });
     
   return ma;
 
 }
 
+// Same stage for one batch of a streamed OBJ file, with the colors of
+// applyColors()
+auto addVertexWeights(const OBJStream::Batch& batch) {
+
+  using VA = ElementAttribute<Color, Weight>;
+  using TA = void;
+  using BA = BatchAttribute<VA, TA>;
+
+  auto ba = BA::New(batch);
+
+  parallelFor(ba->vertexAttributes(), grainSize, [&](auto i) {
+    ba->setVertexAttributes(i, Color{0, 1, 0}, ba->vertex(i).y);
+  });
+
+  return ba;
+
+}
+
 auto addBrightness(const ObjectPtr<MeshAttribute<ElementAttribute<Color>, ElementAttribute<Color>>>& base) {
 
   using VA = void;
   using TA = ElementAttribute<Color, Brightness>;
   using MA = MeshAttribute<VA, TA>;
 
+  const DirectionalLight lights[]{
+    {{0, 1, 0}, 0.7f},
+    {{1, 0.5f, 1}, 0.3f}
+  };
+
   auto ma = MA::New(base->mesh());
 
-  auto nt = ma->mesh().data().triangleCount();
+  parallelFor(ma->triangleAttributes(), grainSize, [&](auto i) {
+    ma->setTriangleAttribute<0>(i, base->triangleAttribute<0>(i));
+  });
 
-  for (decltype(nt) i = 0; i < nt; ++i)
-    ma->setTriangleAttributes(i, base->triangleAttribute<0>(i), i % 2 == 0 ? 1.0f : 0.5f);
+  lambert(ma->mesh(), lights, std::size(lights), ma->triangleAttributeData<1>());
 
   return ma;
 
@@ -84,17 +118,33 @@ auto addShadow(const ObjectPtr<MeshAttribute<void, ElementAttribute<Color, Brigh
   using TA = ElementAttribute<Color, Brightness, Shadow>;
   using MA = MeshAttribute<VA, TA>;
 
+  constexpr unsigned raysPerTriangle = 64;
+
   auto ma = MA::New(brightness->mesh());
 
   auto nt = ma->mesh().data().triangleCount();
 
-  for (decltype(nt) i = 0; i < nt; ++i)
+  auto bvh = BVH::New(ma->mesh());
+
+  std::vector<float> occlusion(nt);
+
+  auto start = std::chrono::steady_clock::now();
+
+  auto rays = ambientOcclusion(*bvh, raysPerTriangle, occlusion.data());
+
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Ambient occlusion: " << rays << " rays in " << seconds.count()
+    << " s (" << rays / seconds.count() * 1e-6 << " Mrays/s)\n";
+
+  parallelFor(ma->triangleAttributes(), grainSize, [&](auto i) {
     ma->setTriangleAttributes(
-      i, 
-      brightness->triangleAttribute<0>(i), 
+      i,
+      brightness->triangleAttribute<0>(i),
       brightness->triangleAttribute<1>(i),
-      1.0f - brightness->triangleAttribute<1>(i)
+      occlusion[i]
     );
+  });
 
   return ma;
 
@@ -118,23 +168,19 @@ inline auto pipeLine(const TriangleMesh& mesh) {
 
   auto finalStage = MA::New(mesh); 
 
-  auto nv = mesh.data().vertexCount();
-  auto nt = mesh.data().triangleCount();
+  transform(
+    stageWeight->vertexAttributes(),
+    finalStage->vertexAttributes(),
+    grainSize,
+    [](const auto& v) { return v; }
+  );
 
-  for(decltype(nv) i = 0; i < nv; ++i)
-    finalStage->setVertexAttributes(
-      i,
-      stageWeight->vertexAttribute<0>(i),
-      stageWeight->vertexAttribute<1>(i)
-    );
-
-  for(decltype(nt) i = 0; i < nt; ++i) 
-    finalStage->setTriangleAttributes(
-      i,
-      stageShadow->triangleAttribute<0>(i),
-      stageShadow->triangleAttribute<1>(i),
-      stageShadow->triangleAttribute<2>(i)
-    );
+  transform(
+    stageShadow->triangleAttributes(),
+    finalStage->triangleAttributes(),
+    grainSize,
+    [](const auto& t) { return t; }
+  );
 
   return finalStage;
 
@@ -145,15 +191,76 @@ main()
 {
 
   auto filename = "meshes/f-16.obj";
-  auto mesh = readOBJ(filename);
+  auto mesh = readOBJ(filename, 0);
 
   if (!mesh)
     printf("Could not read '%s'\n", filename);
   else
     mesh->print(filename);
 
+  mesh->sortVertices();
+
+  auto acmr = mesh->acmr();
+
+  mesh->optimizeVertexCache();
+
+  std::cout << "ACMR: " << acmr << " -> " << mesh->acmr() << '\n';
+
+  auto meshlets = Meshlets::New(*mesh);
+
+  std::cout << "Meshlets: " << meshlets->count() << " (" <<
+  float(mesh->data().triangleCount()) / meshlets->count() << " triangles each), " <<
+  meshlets->memorySize() << " bytes\n";
+
+  auto components = connectedComponents(*mesh);
+
+  std::cout << "Components: " << components.count() << " (largest: " <<
+  *std::max_element(components.triangleCounts.begin(), components.triangleCounts.end()) <<
+  " triangles)\n";
+
   auto attributes = pipeLine(*mesh);
 
+  const float ratios[]{0.5f, 0.25f, 0.1f};
+
+  auto start = std::chrono::steady_clock::now();
+
+  auto lods = simplify(*mesh, ratios, std::size(ratios));
+
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  std::cout << "Simplification: " << lods.size() << " levels in " << seconds.count() << " s\n";
+
+  for (auto& lod : lods) {
+
+    auto lodAttributes = transferVertexAttributes(*attributes, *lod.mesh, lod.vertexMap);
+
+    std::cout << "LOD: " << lod.mesh->data().triangleCount() << " triangles, " <<
+    lod.mesh->data().vertexCount() << " vertices, error " << lod.error <<
+    ", weight of vertex 0 " << lodAttributes->vertexAttribute<1>(0) << '\n';
+
+  }
+
+  if (auto stream = OBJStream::New(filename, 1 << 12)) {
+
+    OBJStream::Batch batch;
+    unsigned batches = 0;
+    auto maxWeight = std::numeric_limits<Weight>::lowest();
+
+    while (stream->next(batch)) {
+
+      auto weights = addVertexWeights(batch);
+
+      for (MeshIndex i = 0; i < batch.vertices.size(); ++i)
+        maxWeight = std::max(maxWeight, weights->vertexAttribute<1>(i));
+      ++batches;
+
+    }
+
+    std::cout << "Streamed " << stream->vertexCount() << " vertices in " <<
+    batches << " batches, max weight " << maxWeight << '\n';
+
+  }
+
   std::cout << std::string(30, '=') << '\n' <<
   "VERTEX ATTRIBUTES" << '\n' <<
   std::string(30, '=') << '\n';
@@ -0,0 +1,116 @@
+// OVERVIEW: MappedFile.cpp
+// ========
+// Source file for memory-mapped file.
+//
+// Last revision: 17/10/2026
+
+#include "util/MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+#ifdef _WIN32
+
+ObjectPtr<MappedFile>
+MappedFile::New(const char* filename, Access access)
+{
+  auto file = CreateFileA(filename,
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    nullptr);
+
+  if (file == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  LARGE_INTEGER size;
+  void* data{};
+
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+  {
+    auto cow = access == Access::CopyOnWrite;
+    auto mapping = CreateFileMappingA(file,
+      nullptr,
+      cow ? PAGE_WRITECOPY : PAGE_READONLY,
+      0,
+      0,
+      nullptr);
+
+    if (mapping != nullptr)
+    {
+      data = MapViewOfFile(mapping, cow ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+  if (data == nullptr)
+    return nullptr;
+  return new MappedFile{data, (size_t)size.QuadPart, access};
+}
+
+MappedFile::~MappedFile()
+{
+  UnmapViewOfFile(_data);
+}
+
+void
+MappedFile::adviseSequential() const
+{
+  // do nothing
+}
+
+#else
+
+ObjectPtr<MappedFile>
+MappedFile::New(const char* filename, Access access)
+{
+  auto fd = ::open(filename, O_RDONLY);
+
+  if (fd < 0)
+    return nullptr;
+
+  struct stat info;
+  void* data{MAP_FAILED};
+
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+  {
+    auto prot = PROT_READ;
+
+    if (access == Access::CopyOnWrite)
+      prot |= PROT_WRITE;
+    data = mmap(nullptr, (size_t)info.st_size, prot, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+  return new MappedFile{data, (size_t)info.st_size, access};
+}
+
+MappedFile::~MappedFile()
+{
+  munmap(_data, _size);
+}
+
+void
+MappedFile::adviseSequential() const
+{
+  madvise(_data, _size, MADV_SEQUENTIAL);
+}
+
+#endif // _WIN32
+
+} // end namespace tcii::cg
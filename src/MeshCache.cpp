@@ -0,0 +1,378 @@
+// OVERVIEW: MeshCache.cpp
+// ========
+// Source file for binary mesh cache.
+//
+// Last revision: 17/10/2026
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif // _MSC_VER
+
+#include "TriangleMesh.h"
+#include "util/MappedFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+//
+// Cache file layout: a 128-byte header followed by the vertex, vertex
+// normal and triangle sections. Every section starts at a multiple of
+// sectionAlignment and is zero padded up to the next section, so the
+// arrays can be used in place once the file is mapped.
+//
+constexpr char magic[8] = {'T', 'C', 'I', 'I', 'M', 'S', 'H', '\0'};
+constexpr uint32_t version = 1;
+constexpr uint32_t byteOrder = 0x01020304;
+constexpr uint64_t sectionAlignment = 64;
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t headerSize;
+  uint32_t vertexSize; // sizeof(TriangleMesh::vec3)
+  uint32_t triangleSize; // sizeof(TriangleMesh::Triangle)
+  uint32_t vertexCount;
+  uint32_t triangleCount;
+  uint32_t reserved;
+  uint64_t vertexOffset;
+  uint64_t normalOffset; // 0 if there are no vertex normals
+  uint64_t triangleOffset;
+  uint64_t fileSize;
+  uint64_t sourceSize;
+  int64_t sourceTime;
+  uint64_t checksum; // of the bytes in [headerSize, fileSize)
+  uint8_t padding[32];
+
+}; // Header
+
+static_assert(sizeof(Header) == 128);
+static_assert(sizeof(Header) % sectionAlignment == 0);
+
+inline auto
+align(uint64_t offset)
+{
+  return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+}
+
+//
+// Four-lane multiplicative hash over 64-bit words. The lanes are
+// independent, so the loop is bound by memory bandwidth rather than
+// by multiplication latency.
+//
+class Checksum
+{
+public:
+  void update(const char* data, size_t size)
+  {
+    _size += size;
+    if (_pending != 0)
+    {
+      auto n = std::min(size, sizeof _buffer - _pending);
+
+      memcpy(_buffer + _pending, data, n);
+      data += n;
+      size -= n;
+      if ((_pending += n) < sizeof _buffer)
+        return;
+      block(_buffer);
+      _pending = 0;
+    }
+    for (; size >= sizeof _buffer; data += sizeof _buffer)
+    {
+      block(data);
+      size -= sizeof _buffer;
+    }
+    memcpy(_buffer, data, _pending = size);
+  }
+
+  uint64_t value() const
+  {
+    assert(_pending == 0);
+
+    uint64_t s = _size;
+
+    for (int k = 0; k < 4; ++k)
+      s = (s ^ _h[k]) * prime;
+    return s ^ (s >> 32);
+  }
+
+private:
+  static constexpr uint64_t prime = 0x9e3779b97f4a7c15ull;
+
+  uint64_t _h[4]{1, 2, 3, 4};
+  uint64_t _size{};
+  char _buffer[32];
+  size_t _pending{};
+
+  void block(const char* data)
+  {
+    for (int k = 0; k < 4; ++k)
+    {
+      uint64_t w;
+
+      memcpy(&w, data + 8 * k, 8);
+      _h[k] = (_h[k] ^ w) * prime;
+      _h[k] ^= _h[k] >> 29;
+    }
+  }
+
+}; // Checksum
+
+struct SourceStamp
+{
+  uint64_t size{};
+  int64_t time{};
+
+}; // SourceStamp
+
+bool
+getSourceStamp(const char* source, SourceStamp& stamp)
+{
+  if (source == nullptr)
+    return true;
+
+  namespace fs = std::filesystem;
+  std::error_code error;
+  auto size = fs::file_size(source, error);
+
+  if (error)
+    return false;
+
+  auto time = fs::last_write_time(source, error);
+
+  if (error)
+    return false;
+  stamp.size = size;
+  stamp.time = (int64_t)time.time_since_epoch().count();
+  return true;
+}
+
+bool
+writeBytes(FILE* file,
+  const void* data,
+  uint64_t size,
+  uint64_t& offset,
+  Checksum& checksum)
+{
+  if (fwrite(data, 1, size, file) != size)
+    return false;
+  checksum.update((const char*)data, size);
+  offset += size;
+  return true;
+}
+
+//
+// Writes zeros up to the start of the next section
+//
+bool
+endSection(FILE* file, uint64_t& offset, Checksum& checksum)
+{
+  static const char zeros[sectionAlignment]{};
+
+  return writeBytes(file, zeros, align(offset) - offset, offset, checksum);
+}
+
+bool
+writeSection(FILE* file,
+  const void* data,
+  uint64_t size,
+  uint64_t& offset,
+  Checksum& checksum)
+{
+  return writeBytes(file, data, size, offset, checksum) &&
+    endSection(file, offset, checksum);
+}
+
+//
+// Vectors are always written as an array of vec3. Coordinate columns
+// are interleaved through a small buffer
+//
+bool
+writeSection(FILE* file,
+  const TriangleMesh::Vec3Array& v,
+  uint64_t& offset,
+  Checksum& checksum)
+{
+  using vec3 = TriangleMesh::vec3;
+
+  if (auto data = v.data())
+    return writeSection(file, data, v.size() * sizeof(vec3), offset, checksum);
+
+  constexpr size_t bufferSize = 1024;
+  vec3 buffer[bufferSize];
+
+  for (size_t i = 0; i < v.size(); i += bufferSize)
+  {
+    auto n = std::min(bufferSize, v.size() - i);
+
+    for (size_t k = 0; k < n; ++k)
+      buffer[k] = v[i + k];
+    if (!writeBytes(file, buffer, n * sizeof(vec3), offset, checksum))
+      return false;
+  }
+  return endSection(file, offset, checksum);
+}
+
+} // end namespace
+
+bool
+writeMeshCache(const TriangleMesh& mesh, const char* filename, const char* source)
+{
+  using vec3 = TriangleMesh::vec3;
+  using Triangle = TriangleMesh::Triangle;
+
+  SourceStamp stamp;
+
+  if (!getSourceStamp(source, stamp))
+    return false;
+
+  auto& data = mesh.data();
+  auto nv = data.vertexCount();
+  auto nt = data.triangleCount();
+  Header header{};
+
+  memcpy(header.magic, magic, sizeof magic);
+  header.version = version;
+  header.byteOrder = byteOrder;
+  header.headerSize = sizeof(Header);
+  header.vertexSize = sizeof(vec3);
+  header.triangleSize = sizeof(Triangle);
+  header.vertexCount = nv;
+  header.triangleCount = nt;
+  header.vertexOffset = sizeof(Header);
+
+  auto offset = align(header.vertexOffset + nv * sizeof(vec3));
+
+  if (mesh.hasVertexNormals())
+  {
+    header.normalOffset = offset;
+    offset = align(offset + nv * sizeof(vec3));
+  }
+  header.triangleOffset = offset;
+  header.fileSize = align(offset + nt * sizeof(Triangle));
+  header.sourceSize = stamp.size;
+  header.sourceTime = stamp.time;
+
+  // Write to a temporary file and rename it, so that a concurrent
+  // reader never maps a partially written cache. The header is
+  // rewritten with the checksum once all sections are out
+  auto temp = std::string{filename} + ".tmp";
+  auto file = fopen(temp.c_str(), "wb");
+
+  if (file == nullptr)
+    return false;
+
+  Checksum checksum;
+  uint64_t written = sizeof header;
+  auto ok = fwrite(&header, sizeof header, 1, file) == 1;
+
+  ok = ok && writeSection(file, data.vertices(), written, checksum);
+  if (ok && header.normalOffset != 0)
+    ok = writeSection(file, data.vertexNormals(), written, checksum);
+  ok = ok && writeSection(file,
+    data.triangles().data(),
+    nt * sizeof(Triangle),
+    written,
+    checksum);
+  if (ok)
+  {
+    assert(written == header.fileSize);
+    header.checksum = checksum.value();
+    ok = fseek(file, 0, SEEK_SET) == 0 &&
+      fwrite(&header, sizeof header, 1, file) == 1;
+  }
+  ok = fclose(file) == 0 && ok;
+
+  std::error_code error;
+
+  if (ok)
+    std::filesystem::rename(temp, filename, error);
+  if (!ok || error)
+  {
+    std::filesystem::remove(temp, error);
+    return false;
+  }
+  return true;
+}
+
+ObjectPtr<TriangleMesh>
+readMeshCache(const char* filename, const char* source)
+{
+  using vec3 = TriangleMesh::vec3;
+  using Triangle = TriangleMesh::Triangle;
+
+  SourceStamp stamp;
+
+  if (!getSourceStamp(source, stamp))
+    return nullptr;
+
+  // Mapped copy-on-write, so the mesh can be modified (e.g., its
+  // vertex normals recomputed) without touching the cache file
+  auto file = MappedFile::New(filename, MappedFile::Access::CopyOnWrite);
+
+  if (file == nullptr || file->size() < sizeof(Header))
+    return nullptr;
+
+  Header header;
+
+  memcpy(&header, file->data(), sizeof header);
+
+  auto nv = (uint64_t)header.vertexCount;
+  auto nt = (uint64_t)header.triangleCount;
+  auto validSection = [&](uint64_t offset, uint64_t size)
+  {
+    return offset % sectionAlignment == 0 &&
+      offset >= sizeof(Header) &&
+      offset <= header.fileSize &&
+      size <= header.fileSize - offset;
+  };
+
+  if (memcmp(header.magic, magic, sizeof magic) != 0 ||
+    header.version != version ||
+    header.byteOrder != byteOrder ||
+    header.headerSize != sizeof(Header) ||
+    header.vertexSize != sizeof(vec3) ||
+    header.triangleSize != sizeof(Triangle) ||
+    header.fileSize != file->size() ||
+    header.fileSize % sectionAlignment != 0 ||
+    nv < 3 || nt < 1 ||
+    !validSection(header.vertexOffset, nv * sizeof(vec3)) ||
+    (header.normalOffset != 0 &&
+      !validSection(header.normalOffset, nv * sizeof(vec3))) ||
+    !validSection(header.triangleOffset, nt * sizeof(Triangle)))
+    return nullptr;
+  if (source != nullptr &&
+    (header.sourceSize != stamp.size || header.sourceTime != stamp.time))
+    return nullptr;
+
+  auto base = file->data();
+  Checksum checksum;
+
+  checksum.update(base + sizeof(Header), header.fileSize - sizeof(Header));
+  if (header.checksum != checksum.value())
+    return nullptr;
+
+  auto normals = header.normalOffset ?
+    (vec3*)(base + header.normalOffset) :
+    nullptr;
+  TriangleMesh::Data data{file,
+    (TriangleMesh::index_t)nv,
+    (vec3*)(base + header.vertexOffset),
+    normals,
+    (TriangleMesh::index_t)nt,
+    (Triangle*)(base + header.triangleOffset)};
+
+  return new TriangleMesh{std::move(data)};
+}
+
+} // end namespace tcii::cg
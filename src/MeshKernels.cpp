@@ -0,0 +1,1084 @@
+// OVERVIEW: MeshKernels.cpp
+// ========
+// Source file for vectorized mesh kernels.
+//
+// Last revision: 17/10/2026
+
+#include "MeshKernels.h"
+#include <climits>
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MESH_KERNELS_X86
+#include <immintrin.h>
+#endif // __GNUC__ && __x86_64__
+
+namespace tcii::cg::kernels
+{ // begin namespace tcii::cg::kernels
+
+namespace
+{ // begin namespace
+
+/////////////////////////////////////////////////////////////////////
+//
+// Scalar kernels (also used for the remainders of vector loops)
+//
+inline void
+faceNormal(const PointColumns& p,
+  const unsigned* t,
+  float& nx,
+  float& ny,
+  float& nz)
+{
+  auto s = p.stride();
+  auto i = t[0] * s;
+  auto j = t[1] * s;
+  auto k = t[2] * s;
+  auto x = p.x();
+  auto y = p.y();
+  auto z = p.z();
+  auto ux = x[j] - x[i];
+  auto uy = y[j] - y[i];
+  auto uz = z[j] - z[i];
+  auto vx = x[k] - x[i];
+  auto vy = y[k] - y[i];
+  auto vz = z[k] - z[i];
+  auto cx = uy * vz - uz * vy;
+  auto cy = uz * vx - ux * vz;
+  auto cz = ux * vy - uy * vx;
+  auto r = 1 / std::sqrt(cx * cx + cy * cy + cz * cz);
+
+  nx = r * cx;
+  ny = r * cy;
+  nz = r * cz;
+}
+
+void
+faceNormalsScalar(const PointColumns& p,
+  const unsigned* t,
+  size_t count,
+  float* nx,
+  float* ny,
+  float* nz)
+{
+  for (size_t k = 0; k < count; ++k, t += 3)
+    faceNormal(p, t, nx[k], ny[k], nz[k]);
+}
+
+void
+normalizeScalar(Vec3f* v, size_t count)
+{
+  for (; count--; ++v)
+    *v = v->versor();
+}
+
+void
+normalizeScalar(float* x, float* y, float* z, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    auto r = 1 / std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+
+    x[i] *= r;
+    y[i] *= r;
+    z[i] *= r;
+  }
+}
+
+//
+// Lambert kernels. The normal of a triangle is the normalized sum of
+// its vertex normals; a zero sum gives a NaN normal, whose dot products
+// are clamped to 0 (max(d, 0) returns the second operand on NaN)
+//
+void
+lambertScalar(const PointColumns& n,
+  const unsigned* t,
+  size_t count,
+  const float* lights,
+  size_t lightCount,
+  float* brightness)
+{
+  auto s = n.stride();
+  auto x = n.x();
+  auto y = n.y();
+  auto z = n.z();
+
+  for (size_t k = 0; k < count; ++k, t += 3)
+  {
+    auto i = t[0] * s;
+    auto j = t[1] * s;
+    auto l = t[2] * s;
+    auto nx = x[i] + x[j] + x[l];
+    auto ny = y[i] + y[j] + y[l];
+    auto nz = z[i] + z[j] + z[l];
+    auto r = 1 / std::sqrt(nx * nx + ny * ny + nz * nz);
+    auto b = 0.0f;
+
+    nx *= r;
+    ny *= r;
+    nz *= r;
+    for (auto light = lights; light != lights + 4 * lightCount; light += 4)
+    {
+      auto d = nx * light[0] + ny * light[1] + nz * light[2];
+
+      b += light[3] * (d > 0 ? d : 0);
+    }
+    brightness[k] = b;
+  }
+}
+
+//
+// Bounds kernels extend the current minimum and maximum. Comparisons
+// are written so that NaN coordinates are ignored, as in
+// Bounds3::inflate()
+//
+inline void
+extend(float v, float& min, float& max)
+{
+  min = v < min ? v : min;
+  max = v > max ? v : max;
+}
+
+void
+boundsScalar(const Vec3f* v, size_t count, float* min, float* max)
+{
+  for (; count--; ++v)
+    for (int c = 0; c < 3; ++c)
+      extend((*v)[c], min[c], max[c]);
+}
+
+void
+boundsScalar(const float* a, size_t count, float& min, float& max)
+{
+  for (size_t i = 0; i < count; ++i)
+    extend(a[i], min, max);
+}
+
+//
+// Merges the lanes of the minimum/maximum registers of a vector
+// bounds kernel. Lane j of the registers holds coordinate j % 3
+// (an array of Vec3f is scanned as a flat array of floats).
+//
+void
+mergeLanes(const float* lo, const float* hi, int n, float* min, float* max)
+{
+  for (int j = 0; j < n; ++j)
+  {
+    auto c = j % 3;
+
+    min[c] = lo[j] < min[c] ? lo[j] : min[c];
+    max[c] = hi[j] > max[c] ? hi[j] : max[c];
+  }
+}
+
+#ifdef MESH_KERNELS_X86
+
+//
+// The vector kernels compute 1/sqrt(x) with the hardware reciprocal
+// square root estimate refined by one Newton-Raphson step:
+// y' = y * (1.5 - 0.5 * x * y * y)
+//
+
+/////////////////////////////////////////////////////////////////////
+//
+// SSE kernels (4 lanes)
+//
+inline __m128
+rsqrt(__m128 x)
+{
+  auto y = _mm_rsqrt_ps(x);
+  auto h = _mm_mul_ps(_mm_set1_ps(0.5f), x);
+
+  return _mm_mul_ps(y,
+    _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(h, _mm_mul_ps(y, y))));
+}
+
+inline __m128
+load(const float* a, const unsigned* t, size_t s)
+{
+  return _mm_setr_ps(a[t[0] * s], a[t[3] * s], a[t[6] * s], a[t[9] * s]);
+}
+
+void
+faceNormalsSSE(const PointColumns& p,
+  const unsigned* t,
+  size_t count,
+  float* nx,
+  float* ny,
+  float* nz)
+{
+  auto s = p.stride();
+  auto x = p.x();
+  auto y = p.y();
+  auto z = p.z();
+  size_t k = 0;
+
+  for (; k + 4 <= count; k += 4, t += 12)
+  {
+    auto x0 = load(x, t, s);
+    auto y0 = load(y, t, s);
+    auto z0 = load(z, t, s);
+    auto ux = _mm_sub_ps(load(x, t + 1, s), x0);
+    auto uy = _mm_sub_ps(load(y, t + 1, s), y0);
+    auto uz = _mm_sub_ps(load(z, t + 1, s), z0);
+    auto vx = _mm_sub_ps(load(x, t + 2, s), x0);
+    auto vy = _mm_sub_ps(load(y, t + 2, s), y0);
+    auto vz = _mm_sub_ps(load(z, t + 2, s), z0);
+    auto cx = _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy));
+    auto cy = _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz));
+    auto cz = _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx));
+    auto r = rsqrt(_mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx),
+      _mm_mul_ps(cy, cy)),
+      _mm_mul_ps(cz, cz)));
+
+    _mm_storeu_ps(nx + k, _mm_mul_ps(r, cx));
+    _mm_storeu_ps(ny + k, _mm_mul_ps(r, cy));
+    _mm_storeu_ps(nz + k, _mm_mul_ps(r, cz));
+  }
+  faceNormalsScalar(p, t, count - k, nx + k, ny + k, nz + k);
+}
+
+void
+lambertSSE(const PointColumns& n,
+  const unsigned* t,
+  size_t count,
+  const float* lights,
+  size_t lightCount,
+  float* brightness)
+{
+  auto s = n.stride();
+  auto x = n.x();
+  auto y = n.y();
+  auto z = n.z();
+  const auto zero = _mm_setzero_ps();
+  size_t k = 0;
+
+  for (; k + 4 <= count; k += 4, t += 12)
+  {
+    auto nx = _mm_add_ps(_mm_add_ps(load(x, t, s), load(x, t + 1, s)),
+      load(x, t + 2, s));
+    auto ny = _mm_add_ps(_mm_add_ps(load(y, t, s), load(y, t + 1, s)),
+      load(y, t + 2, s));
+    auto nz = _mm_add_ps(_mm_add_ps(load(z, t, s), load(z, t + 1, s)),
+      load(z, t + 2, s));
+    auto r = rsqrt(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx),
+      _mm_mul_ps(ny, ny)),
+      _mm_mul_ps(nz, nz)));
+    auto b = zero;
+
+    nx = _mm_mul_ps(nx, r);
+    ny = _mm_mul_ps(ny, r);
+    nz = _mm_mul_ps(nz, r);
+    for (auto light = lights; light != lights + 4 * lightCount; light += 4)
+    {
+      auto d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_set1_ps(light[0])),
+        _mm_mul_ps(ny, _mm_set1_ps(light[1]))),
+        _mm_mul_ps(nz, _mm_set1_ps(light[2])));
+
+      b = _mm_add_ps(b, _mm_mul_ps(_mm_set1_ps(light[3]), _mm_max_ps(d, zero)));
+    }
+    _mm_storeu_ps(brightness + k, b);
+  }
+  lambertScalar(n, t, count - k, lights, lightCount, brightness + k);
+}
+
+//
+// Four Vec3f are 12 consecutive floats. The inverse lengths r0..r3
+// are spread over the three registers holding them as (r0,r0,r0,r1),
+// (r1,r1,r2,r2) and (r2,r3,r3,r3).
+//
+void
+normalizeSSE(Vec3f* v, size_t count)
+{
+  size_t k = 0;
+
+  for (; k + 4 <= count; k += 4)
+  {
+    auto f = &v[k].x;
+    auto x = _mm_setr_ps(f[0], f[3], f[6], f[9]);
+    auto y = _mm_setr_ps(f[1], f[4], f[7], f[10]);
+    auto z = _mm_setr_ps(f[2], f[5], f[8], f[11]);
+    auto r = rsqrt(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x),
+      _mm_mul_ps(y, y)),
+      _mm_mul_ps(z, z)));
+
+    _mm_storeu_ps(f, _mm_mul_ps(_mm_loadu_ps(f),
+      _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 0, 0))));
+    _mm_storeu_ps(f + 4, _mm_mul_ps(_mm_loadu_ps(f + 4),
+      _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 1, 1))));
+    _mm_storeu_ps(f + 8, _mm_mul_ps(_mm_loadu_ps(f + 8),
+      _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 2))));
+  }
+  normalizeScalar(v + k, count - k);
+}
+
+void
+normalizeSSE(float* x, float* y, float* z, size_t count)
+{
+  size_t k = 0;
+
+  for (; k + 4 <= count; k += 4)
+  {
+    auto vx = _mm_loadu_ps(x + k);
+    auto vy = _mm_loadu_ps(y + k);
+    auto vz = _mm_loadu_ps(z + k);
+    auto r = rsqrt(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx),
+      _mm_mul_ps(vy, vy)),
+      _mm_mul_ps(vz, vz)));
+
+    _mm_storeu_ps(x + k, _mm_mul_ps(vx, r));
+    _mm_storeu_ps(y + k, _mm_mul_ps(vy, r));
+    _mm_storeu_ps(z + k, _mm_mul_ps(vz, r));
+  }
+  normalizeScalar(x + k, y + k, z + k, count - k);
+}
+
+//
+// The vector min/max take the loaded values as first operand: when
+// that operand is NaN, the instructions return the second one
+//
+void
+boundsSSE(const Vec3f* v, size_t count, float* min, float* max)
+{
+  size_t k = 0;
+
+  if (count >= 4)
+  {
+    // Register r starts at float 4r of a block, so lane j of the
+    // registers holds coordinate (4r + j) % 3; seed them accordingly
+    __m128 lo[3];
+    __m128 hi[3];
+    float l[12];
+    float h[12];
+
+    for (int j = 0; j < 12; ++j)
+    {
+      l[j] = min[j % 3];
+      h[j] = max[j % 3];
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+      lo[r] = _mm_loadu_ps(l + 4 * r);
+      hi[r] = _mm_loadu_ps(h + 4 * r);
+    }
+    for (; k + 4 <= count; k += 4)
+    {
+      auto f = &v[k].x;
+
+      for (int r = 0; r < 3; ++r)
+      {
+        auto a = _mm_loadu_ps(f + 4 * r);
+
+        lo[r] = _mm_min_ps(a, lo[r]);
+        hi[r] = _mm_max_ps(a, hi[r]);
+      }
+    }
+
+    for (int r = 0; r < 3; ++r)
+    {
+      _mm_storeu_ps(l + 4 * r, lo[r]);
+      _mm_storeu_ps(h + 4 * r, hi[r]);
+    }
+    mergeLanes(l, h, 12, min, max);
+  }
+  boundsScalar(v + k, count - k, min, max);
+}
+
+void
+boundsSSE(const float* a, size_t count, float& min, float& max)
+{
+  size_t k = 0;
+
+  if (count >= 4)
+  {
+    auto lo = _mm_set1_ps(min);
+    auto hi = _mm_set1_ps(max);
+
+    for (; k + 4 <= count; k += 4)
+    {
+      auto x = _mm_loadu_ps(a + k);
+
+      lo = _mm_min_ps(x, lo);
+      hi = _mm_max_ps(x, hi);
+    }
+
+    float l[4];
+    float h[4];
+
+    _mm_storeu_ps(l, lo);
+    _mm_storeu_ps(h, hi);
+    for (int j = 0; j < 4; ++j)
+    {
+      min = l[j] < min ? l[j] : min;
+      max = h[j] > max ? h[j] : max;
+    }
+  }
+  boundsScalar(a + k, count - k, min, max);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// AVX2 kernels (8 lanes)
+//
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+TARGET_AVX2 inline __m256
+rsqrt(__m256 x)
+{
+  auto y = _mm256_rsqrt_ps(x);
+  auto h = _mm256_mul_ps(_mm256_set1_ps(0.5f), x);
+
+  return _mm256_mul_ps(y,
+    _mm256_sub_ps(_mm256_set1_ps(1.5f),
+      _mm256_mul_ps(h, _mm256_mul_ps(y, y))));
+}
+
+TARGET_AVX2 void
+faceNormalsAVX2(const PointColumns& p,
+  const unsigned* t,
+  size_t count,
+  float* nx,
+  float* ny,
+  float* nz)
+{
+  // Offsets of the first vertex index of 8 consecutive triangles
+  const auto offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const auto stride = _mm256_set1_epi32((int)p.stride());
+  size_t k = 0;
+
+  for (; k + 8 <= count; k += 8, t += 24)
+  {
+    __m256 x[3];
+    __m256 y[3];
+    __m256 z[3];
+
+    for (int c = 0; c < 3; ++c)
+    {
+      auto i = _mm256_i32gather_epi32((const int*)t + c, offsets, 4);
+
+      i = _mm256_mullo_epi32(i, stride);
+      x[c] = _mm256_i32gather_ps(p.x(), i, 4);
+      y[c] = _mm256_i32gather_ps(p.y(), i, 4);
+      z[c] = _mm256_i32gather_ps(p.z(), i, 4);
+    }
+
+    auto ux = _mm256_sub_ps(x[1], x[0]);
+    auto uy = _mm256_sub_ps(y[1], y[0]);
+    auto uz = _mm256_sub_ps(z[1], z[0]);
+    auto vx = _mm256_sub_ps(x[2], x[0]);
+    auto vy = _mm256_sub_ps(y[2], y[0]);
+    auto vz = _mm256_sub_ps(z[2], z[0]);
+    auto cx = _mm256_sub_ps(_mm256_mul_ps(uy, vz), _mm256_mul_ps(uz, vy));
+    auto cy = _mm256_sub_ps(_mm256_mul_ps(uz, vx), _mm256_mul_ps(ux, vz));
+    auto cz = _mm256_sub_ps(_mm256_mul_ps(ux, vy), _mm256_mul_ps(uy, vx));
+    auto r = rsqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx),
+      _mm256_mul_ps(cy, cy)),
+      _mm256_mul_ps(cz, cz)));
+
+    _mm256_storeu_ps(nx + k, _mm256_mul_ps(r, cx));
+    _mm256_storeu_ps(ny + k, _mm256_mul_ps(r, cy));
+    _mm256_storeu_ps(nz + k, _mm256_mul_ps(r, cz));
+  }
+  faceNormalsSSE(p, t, count - k, nx + k, ny + k, nz + k);
+}
+
+TARGET_AVX2 void
+lambertAVX2(const PointColumns& p,
+  const unsigned* t,
+  size_t count,
+  const float* lights,
+  size_t lightCount,
+  float* brightness)
+{
+  const auto offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const auto stride = _mm256_set1_epi32((int)p.stride());
+  const auto zero = _mm256_setzero_ps();
+  size_t k = 0;
+
+  for (; k + 8 <= count; k += 8, t += 24)
+  {
+    auto nx = zero;
+    auto ny = zero;
+    auto nz = zero;
+
+    for (int c = 0; c < 3; ++c)
+    {
+      auto i = _mm256_i32gather_epi32((const int*)t + c, offsets, 4);
+
+      i = _mm256_mullo_epi32(i, stride);
+      nx = _mm256_add_ps(nx, _mm256_i32gather_ps(p.x(), i, 4));
+      ny = _mm256_add_ps(ny, _mm256_i32gather_ps(p.y(), i, 4));
+      nz = _mm256_add_ps(nz, _mm256_i32gather_ps(p.z(), i, 4));
+    }
+
+    auto r = rsqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx),
+      _mm256_mul_ps(ny, ny)),
+      _mm256_mul_ps(nz, nz)));
+    auto b = zero;
+
+    nx = _mm256_mul_ps(nx, r);
+    ny = _mm256_mul_ps(ny, r);
+    nz = _mm256_mul_ps(nz, r);
+    for (auto light = lights; light != lights + 4 * lightCount; light += 4)
+    {
+      auto d = _mm256_add_ps(_mm256_add_ps(
+        _mm256_mul_ps(nx, _mm256_set1_ps(light[0])),
+        _mm256_mul_ps(ny, _mm256_set1_ps(light[1]))),
+        _mm256_mul_ps(nz, _mm256_set1_ps(light[2])));
+
+      b = _mm256_add_ps(b,
+        _mm256_mul_ps(_mm256_set1_ps(light[3]), _mm256_max_ps(d, zero)));
+    }
+    _mm256_storeu_ps(brightness + k, b);
+  }
+  lambertSSE(p, t, count - k, lights, lightCount, brightness + k);
+}
+
+TARGET_AVX2 void
+normalizeAVX2(Vec3f* v, size_t count)
+{
+  const auto offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  // Lane j of register q holds a coordinate of vector (8q + j) / 3
+  const auto spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+  const auto spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+  const auto spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+  size_t k = 0;
+
+  for (; k + 8 <= count; k += 8)
+  {
+    auto f = &v[k].x;
+    auto x = _mm256_i32gather_ps(f, offsets, 4);
+    auto y = _mm256_i32gather_ps(f + 1, offsets, 4);
+    auto z = _mm256_i32gather_ps(f + 2, offsets, 4);
+    auto r = rsqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x),
+      _mm256_mul_ps(y, y)),
+      _mm256_mul_ps(z, z)));
+
+    _mm256_storeu_ps(f, _mm256_mul_ps(_mm256_loadu_ps(f),
+      _mm256_permutevar8x32_ps(r, spread0)));
+    _mm256_storeu_ps(f + 8, _mm256_mul_ps(_mm256_loadu_ps(f + 8),
+      _mm256_permutevar8x32_ps(r, spread1)));
+    _mm256_storeu_ps(f + 16, _mm256_mul_ps(_mm256_loadu_ps(f + 16),
+      _mm256_permutevar8x32_ps(r, spread2)));
+  }
+  normalizeSSE(v + k, count - k);
+}
+
+TARGET_AVX2 void
+normalizeAVX2(float* x, float* y, float* z, size_t count)
+{
+  size_t k = 0;
+
+  for (; k + 8 <= count; k += 8)
+  {
+    auto vx = _mm256_loadu_ps(x + k);
+    auto vy = _mm256_loadu_ps(y + k);
+    auto vz = _mm256_loadu_ps(z + k);
+    auto r = rsqrt(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx),
+      _mm256_mul_ps(vy, vy)),
+      _mm256_mul_ps(vz, vz)));
+
+    _mm256_storeu_ps(x + k, _mm256_mul_ps(vx, r));
+    _mm256_storeu_ps(y + k, _mm256_mul_ps(vy, r));
+    _mm256_storeu_ps(z + k, _mm256_mul_ps(vz, r));
+  }
+  normalizeSSE(x + k, y + k, z + k, count - k);
+}
+
+TARGET_AVX2 void
+boundsAVX2(const Vec3f* v, size_t count, float* min, float* max)
+{
+  size_t k = 0;
+
+  if (count >= 8)
+  {
+    __m256 lo[3];
+    __m256 hi[3];
+    float l[24];
+    float h[24];
+
+    for (int j = 0; j < 24; ++j)
+    {
+      l[j] = min[j % 3];
+      h[j] = max[j % 3];
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+      lo[r] = _mm256_loadu_ps(l + 8 * r);
+      hi[r] = _mm256_loadu_ps(h + 8 * r);
+    }
+    for (; k + 8 <= count; k += 8)
+    {
+      auto f = &v[k].x;
+
+      for (int r = 0; r < 3; ++r)
+      {
+        auto a = _mm256_loadu_ps(f + 8 * r);
+
+        lo[r] = _mm256_min_ps(a, lo[r]);
+        hi[r] = _mm256_max_ps(a, hi[r]);
+      }
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+      _mm256_storeu_ps(l + 8 * r, lo[r]);
+      _mm256_storeu_ps(h + 8 * r, hi[r]);
+    }
+    mergeLanes(l, h, 24, min, max);
+  }
+  boundsSSE(v + k, count - k, min, max);
+}
+
+TARGET_AVX2 void
+boundsAVX2(const float* a, size_t count, float& min, float& max)
+{
+  size_t k = 0;
+
+  if (count >= 8)
+  {
+    auto lo = _mm256_set1_ps(min);
+    auto hi = _mm256_set1_ps(max);
+
+    for (; k + 8 <= count; k += 8)
+    {
+      auto x = _mm256_loadu_ps(a + k);
+
+      lo = _mm256_min_ps(x, lo);
+      hi = _mm256_max_ps(x, hi);
+    }
+
+    float l[8];
+    float h[8];
+
+    _mm256_storeu_ps(l, lo);
+    _mm256_storeu_ps(h, hi);
+    for (int j = 0; j < 8; ++j)
+    {
+      min = l[j] < min ? l[j] : min;
+      max = h[j] > max ? h[j] : max;
+    }
+  }
+  boundsSSE(a + k, count - k, min, max);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// AVX-512 kernels (16 lanes)
+//
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+
+// GCC 12 reports the _mm512_undefined_* placeholders used inside the
+// AVX-512 intrinsics as uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+TARGET_AVX512 inline __m512
+rsqrt(__m512 x)
+{
+  auto y = _mm512_rsqrt14_ps(x);
+  auto h = _mm512_mul_ps(_mm512_set1_ps(0.5f), x);
+
+  return _mm512_mul_ps(y,
+    _mm512_sub_ps(_mm512_set1_ps(1.5f),
+      _mm512_mul_ps(h, _mm512_mul_ps(y, y))));
+}
+
+TARGET_AVX512 inline __m512i
+tripleOffsets(int first)
+{
+  return _mm512_setr_epi32(first + 0, first + 3, first + 6, first + 9,
+    first + 12, first + 15, first + 18, first + 21,
+    first + 24, first + 27, first + 30, first + 33,
+    first + 36, first + 39, first + 42, first + 45);
+}
+
+TARGET_AVX512 void
+faceNormalsAVX512(const PointColumns& p,
+  const unsigned* t,
+  size_t count,
+  float* nx,
+  float* ny,
+  float* nz)
+{
+  const auto offsets = tripleOffsets(0);
+  const auto stride = _mm512_set1_epi32((int)p.stride());
+  size_t k = 0;
+
+  for (; k + 16 <= count; k += 16, t += 48)
+  {
+    __m512 x[3];
+    __m512 y[3];
+    __m512 z[3];
+
+    for (int c = 0; c < 3; ++c)
+    {
+      auto i = _mm512_i32gather_epi32(offsets, t + c, 4);
+
+      i = _mm512_mullo_epi32(i, stride);
+      x[c] = _mm512_i32gather_ps(i, p.x(), 4);
+      y[c] = _mm512_i32gather_ps(i, p.y(), 4);
+      z[c] = _mm512_i32gather_ps(i, p.z(), 4);
+    }
+
+    auto ux = _mm512_sub_ps(x[1], x[0]);
+    auto uy = _mm512_sub_ps(y[1], y[0]);
+    auto uz = _mm512_sub_ps(z[1], z[0]);
+    auto vx = _mm512_sub_ps(x[2], x[0]);
+    auto vy = _mm512_sub_ps(y[2], y[0]);
+    auto vz = _mm512_sub_ps(z[2], z[0]);
+    auto cx = _mm512_sub_ps(_mm512_mul_ps(uy, vz), _mm512_mul_ps(uz, vy));
+    auto cy = _mm512_sub_ps(_mm512_mul_ps(uz, vx), _mm512_mul_ps(ux, vz));
+    auto cz = _mm512_sub_ps(_mm512_mul_ps(ux, vy), _mm512_mul_ps(uy, vx));
+    auto r = rsqrt(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(cx, cx),
+      _mm512_mul_ps(cy, cy)),
+      _mm512_mul_ps(cz, cz)));
+
+    _mm512_storeu_ps(nx + k, _mm512_mul_ps(r, cx));
+    _mm512_storeu_ps(ny + k, _mm512_mul_ps(r, cy));
+    _mm512_storeu_ps(nz + k, _mm512_mul_ps(r, cz));
+  }
+  faceNormalsAVX2(p, t, count - k, nx + k, ny + k, nz + k);
+}
+
+TARGET_AVX512 void
+lambertAVX512(const PointColumns& p,
+  const unsigned* t,
+  size_t count,
+  const float* lights,
+  size_t lightCount,
+  float* brightness)
+{
+  const auto offsets = tripleOffsets(0);
+  const auto stride = _mm512_set1_epi32((int)p.stride());
+  const auto zero = _mm512_setzero_ps();
+  size_t k = 0;
+
+  for (; k + 16 <= count; k += 16, t += 48)
+  {
+    auto nx = zero;
+    auto ny = zero;
+    auto nz = zero;
+
+    for (int c = 0; c < 3; ++c)
+    {
+      auto i = _mm512_i32gather_epi32(offsets, t + c, 4);
+
+      i = _mm512_mullo_epi32(i, stride);
+      nx = _mm512_add_ps(nx, _mm512_i32gather_ps(i, p.x(), 4));
+      ny = _mm512_add_ps(ny, _mm512_i32gather_ps(i, p.y(), 4));
+      nz = _mm512_add_ps(nz, _mm512_i32gather_ps(i, p.z(), 4));
+    }
+
+    auto r = rsqrt(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(nx, nx),
+      _mm512_mul_ps(ny, ny)),
+      _mm512_mul_ps(nz, nz)));
+    auto b = zero;
+
+    nx = _mm512_mul_ps(nx, r);
+    ny = _mm512_mul_ps(ny, r);
+    nz = _mm512_mul_ps(nz, r);
+    for (auto light = lights; light != lights + 4 * lightCount; light += 4)
+    {
+      auto d = _mm512_add_ps(_mm512_add_ps(
+        _mm512_mul_ps(nx, _mm512_set1_ps(light[0])),
+        _mm512_mul_ps(ny, _mm512_set1_ps(light[1]))),
+        _mm512_mul_ps(nz, _mm512_set1_ps(light[2])));
+
+      b = _mm512_add_ps(b,
+        _mm512_mul_ps(_mm512_set1_ps(light[3]), _mm512_max_ps(d, zero)));
+    }
+    _mm512_storeu_ps(brightness + k, b);
+  }
+  lambertAVX2(p, t, count - k, lights, lightCount, brightness + k);
+}
+
+TARGET_AVX512 void
+normalizeAVX512(Vec3f* v, size_t count)
+{
+  const auto offsets = tripleOffsets(0);
+  // Lane j of register q holds a coordinate of vector (16q + j) / 3
+  const auto spread0 = _mm512_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2,
+    2, 3, 3, 3, 4, 4, 4, 5);
+  const auto spread1 = _mm512_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7,
+    8, 8, 8, 9, 9, 9, 10, 10);
+  const auto spread2 = _mm512_setr_epi32(10, 11, 11, 11, 12, 12, 12, 13,
+    13, 13, 14, 14, 14, 15, 15, 15);
+  size_t k = 0;
+
+  for (; k + 16 <= count; k += 16)
+  {
+    auto f = &v[k].x;
+    auto x = _mm512_i32gather_ps(offsets, f, 4);
+    auto y = _mm512_i32gather_ps(offsets, f + 1, 4);
+    auto z = _mm512_i32gather_ps(offsets, f + 2, 4);
+    auto r = rsqrt(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(x, x),
+      _mm512_mul_ps(y, y)),
+      _mm512_mul_ps(z, z)));
+
+    _mm512_storeu_ps(f, _mm512_mul_ps(_mm512_loadu_ps(f),
+      _mm512_permutexvar_ps(spread0, r)));
+    _mm512_storeu_ps(f + 16, _mm512_mul_ps(_mm512_loadu_ps(f + 16),
+      _mm512_permutexvar_ps(spread1, r)));
+    _mm512_storeu_ps(f + 32, _mm512_mul_ps(_mm512_loadu_ps(f + 32),
+      _mm512_permutexvar_ps(spread2, r)));
+  }
+  normalizeAVX2(v + k, count - k);
+}
+
+TARGET_AVX512 void
+normalizeAVX512(float* x, float* y, float* z, size_t count)
+{
+  size_t k = 0;
+
+  for (; k + 16 <= count; k += 16)
+  {
+    auto vx = _mm512_loadu_ps(x + k);
+    auto vy = _mm512_loadu_ps(y + k);
+    auto vz = _mm512_loadu_ps(z + k);
+    auto r = rsqrt(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(vx, vx),
+      _mm512_mul_ps(vy, vy)),
+      _mm512_mul_ps(vz, vz)));
+
+    _mm512_storeu_ps(x + k, _mm512_mul_ps(vx, r));
+    _mm512_storeu_ps(y + k, _mm512_mul_ps(vy, r));
+    _mm512_storeu_ps(z + k, _mm512_mul_ps(vz, r));
+  }
+  normalizeAVX2(x + k, y + k, z + k, count - k);
+}
+
+TARGET_AVX512 void
+boundsAVX512(const Vec3f* v, size_t count, float* min, float* max)
+{
+  size_t k = 0;
+
+  if (count >= 16)
+  {
+    __m512 lo[3];
+    __m512 hi[3];
+    float l[48];
+    float h[48];
+
+    for (int j = 0; j < 48; ++j)
+    {
+      l[j] = min[j % 3];
+      h[j] = max[j % 3];
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+      lo[r] = _mm512_loadu_ps(l + 16 * r);
+      hi[r] = _mm512_loadu_ps(h + 16 * r);
+    }
+    for (; k + 16 <= count; k += 16)
+    {
+      auto f = &v[k].x;
+
+      for (int r = 0; r < 3; ++r)
+      {
+        auto a = _mm512_loadu_ps(f + 16 * r);
+
+        lo[r] = _mm512_min_ps(a, lo[r]);
+        hi[r] = _mm512_max_ps(a, hi[r]);
+      }
+    }
+    for (int r = 0; r < 3; ++r)
+    {
+      _mm512_storeu_ps(l + 16 * r, lo[r]);
+      _mm512_storeu_ps(h + 16 * r, hi[r]);
+    }
+    mergeLanes(l, h, 48, min, max);
+  }
+  boundsAVX2(v + k, count - k, min, max);
+}
+
+TARGET_AVX512 void
+boundsAVX512(const float* a, size_t count, float& min, float& max)
+{
+  size_t k = 0;
+
+  if (count >= 16)
+  {
+    auto lo = _mm512_set1_ps(min);
+    auto hi = _mm512_set1_ps(max);
+
+    for (; k + 16 <= count; k += 16)
+    {
+      auto x = _mm512_loadu_ps(a + k);
+
+      lo = _mm512_min_ps(x, lo);
+      hi = _mm512_max_ps(x, hi);
+    }
+
+    float l[16];
+    float h[16];
+
+    _mm512_storeu_ps(l, lo);
+    _mm512_storeu_ps(h, hi);
+    for (int j = 0; j < 16; ++j)
+    {
+      min = l[j] < min ? l[j] : min;
+      max = h[j] > max ? h[j] : max;
+    }
+  }
+  boundsAVX2(a + k, count - k, min, max);
+}
+
+#pragma GCC diagnostic pop
+
+enum class ISA
+{
+  SSE,
+  AVX2,
+  AVX512
+};
+
+ISA
+detectISA()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return ISA::AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return ISA::AVX2;
+  return ISA::SSE;
+}
+
+const auto isa = detectISA();
+
+#endif // MESH_KERNELS_X86
+
+} // end namespace
+
+const char*
+isaName()
+{
+#ifdef MESH_KERNELS_X86
+  switch (isa)
+  {
+    case ISA::AVX512:
+      return "AVX-512";
+    case ISA::AVX2:
+      return "AVX2";
+    default:
+      return "SSE";
+  }
+#else
+  return "scalar";
+#endif // MESH_KERNELS_X86
+}
+
+void
+faceNormals(const PointColumns& points,
+  const unsigned* indices,
+  size_t count,
+  float* nx,
+  float* ny,
+  float* nz)
+{
+#ifdef MESH_KERNELS_X86
+  // Gathers take 32-bit signed offsets
+  auto gather = points.size() * points.stride() <= (size_t)INT_MAX;
+
+  if (gather && isa == ISA::AVX512)
+    return faceNormalsAVX512(points, indices, count, nx, ny, nz);
+  if (gather && isa == ISA::AVX2)
+    return faceNormalsAVX2(points, indices, count, nx, ny, nz);
+  faceNormalsSSE(points, indices, count, nx, ny, nz);
+#else
+  faceNormalsScalar(points, indices, count, nx, ny, nz);
+#endif // MESH_KERNELS_X86
+}
+
+void
+lambert(const PointColumns& normals,
+  const unsigned* indices,
+  size_t count,
+  const float* lights,
+  size_t lightCount,
+  float* brightness)
+{
+  if (count == 0)
+    return;
+#ifdef MESH_KERNELS_X86
+  auto gather = normals.size() * normals.stride() <= (size_t)INT_MAX;
+
+  if (gather && isa == ISA::AVX512)
+    return lambertAVX512(normals, indices, count, lights, lightCount, brightness);
+  if (gather && isa == ISA::AVX2)
+    return lambertAVX2(normals, indices, count, lights, lightCount, brightness);
+  lambertSSE(normals, indices, count, lights, lightCount, brightness);
+#else
+  lambertScalar(normals, indices, count, lights, lightCount, brightness);
+#endif // MESH_KERNELS_X86
+}
+
+void
+normalize(const Vec3View<float>& v)
+{
+  auto count = v.size();
+
+  if (count == 0)
+    return;
+  if (auto a = v.data())
+  {
+#ifdef MESH_KERNELS_X86
+    if (isa == ISA::AVX512)
+      return normalizeAVX512(a, count);
+    if (isa == ISA::AVX2)
+      return normalizeAVX2(a, count);
+    normalizeSSE(a, count);
+#else
+    normalizeScalar(a, count);
+#endif // MESH_KERNELS_X86
+    return;
+  }
+  assert(v.stride() == 1);
+#ifdef MESH_KERNELS_X86
+  if (isa == ISA::AVX512)
+    return normalizeAVX512(v.x(), v.y(), v.z(), count);
+  if (isa == ISA::AVX2)
+    return normalizeAVX2(v.x(), v.y(), v.z(), count);
+  normalizeSSE(v.x(), v.y(), v.z(), count);
+#else
+  normalizeScalar(v.x(), v.y(), v.z(), count);
+#endif // MESH_KERNELS_X86
+}
+
+void
+bounds(const PointColumns& points, Vec3f& min, Vec3f& max)
+{
+  auto count = points.size();
+
+  if (count == 0)
+    return;
+  if (auto a = points.data())
+  {
+#ifdef MESH_KERNELS_X86
+    if (isa == ISA::AVX512)
+      return boundsAVX512(a, count, &min.x, &max.x);
+    if (isa == ISA::AVX2)
+      return boundsAVX2(a, count, &min.x, &max.x);
+    boundsSSE(a, count, &min.x, &max.x);
+#else
+    boundsScalar(a, count, &min.x, &max.x);
+#endif // MESH_KERNELS_X86
+    return;
+  }
+  assert(points.stride() == 1);
+  for (auto c : {0, 1, 2})
+  {
+    auto column = c == 0 ? points.x() : c == 1 ? points.y() : points.z();
+
+#ifdef MESH_KERNELS_X86
+    if (isa == ISA::AVX512)
+      boundsAVX512(column, count, min[c], max[c]);
+    else if (isa == ISA::AVX2)
+      boundsAVX2(column, count, min[c], max[c]);
+    else
+      boundsSSE(column, count, min[c], max[c]);
+#else
+    boundsScalar(column, count, min[c], max[c]);
+#endif // MESH_KERNELS_X86
+  }
+}
+
+} // end namespace tcii::cg::kernels
@@ -0,0 +1,303 @@
+// OVERVIEW: Meshlets.cpp
+// ========
+// Source file for meshlets.
+//
+// Last revision: 17/10/2026
+
+#include "Meshlets.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+using index_t = Meshlets::index_t;
+using vec3 = Meshlets::vec3;
+using Meshlet = Meshlets::Meshlet;
+using Culling = Meshlets::Culling;
+
+constexpr auto none = ~index_t{};
+
+// Number of consecutive mesh triangles split into meshlets by a thread
+// at a time. Meshlets do not cross regions; the regions do not depend
+// on the number of threads, nor do the meshlets
+constexpr index_t regionSize = 1 << 12;
+
+//
+// Region: meshlets of a range of mesh triangles
+// ======
+// A meshlet starts at the first unused triangle of the region and
+// grows by the unused triangle that adds the fewest vertices to it,
+// searched first among the triangles adjacent to the last one added
+// and then among those adjacent to any vertex of the meshlet. A
+// meshlet is closed when the next triangle does not fit.
+//
+struct Region
+{
+  index_t begin;
+  index_t end;
+  std::vector<Meshlet> meshlets;
+  std::vector<Culling> culling;
+  std::vector<index_t> vertices;
+  std::vector<Meshlets::Triangle> triangles;
+  std::vector<index_t> triangleIndices;
+
+  void build(const TriangleMesh& mesh);
+
+private:
+  const TriangleMesh::Data* _data;
+  std::vector<uint8_t> _used;
+
+  // Position of v in the vertices of the open meshlet
+  int find(index_t v) const
+  {
+    auto b = vertices.begin() + meshlets.back().vertexOffset;
+    auto p = std::find(b, vertices.end(), v);
+
+    return p == vertices.end() ? -1 : int(p - b);
+  }
+
+  unsigned newVertices(index_t t) const
+  {
+    auto& triangle = _data->triangle(t);
+    auto i = triangle.i;
+    auto j = triangle.j;
+    auto k = triangle.k;
+
+    return (find(i) < 0) + (j != i && find(j) < 0) +
+      (k != i && k != j && find(k) < 0);
+  }
+
+  void add(index_t t);
+  void close();
+
+}; // Region
+
+void
+Region::add(index_t t)
+{
+  auto& meshlet = meshlets.back();
+  auto& triangle = _data->triangle(t);
+  Meshlets::Triangle local;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    auto p = find(triangle[i]);
+
+    if (p < 0)
+    {
+      p = meshlet.vertexCount++;
+      vertices.push_back(triangle[i]);
+    }
+    local[uint8_t(i)] = uint8_t(p);
+  }
+  triangles.push_back(local);
+  triangleIndices.push_back(t);
+  ++meshlet.triangleCount;
+  _used[t - begin] = 1;
+}
+
+//
+// Computes the bounds and normal cone of the open meshlet. The cone
+// axis is the mean of the unit triangle normals and the cutoff is the
+// least cosine between the axis and a normal.
+//
+void
+Region::close()
+{
+  auto& meshlet = meshlets.back();
+  auto positions = _data->vertices();
+  auto indices = vertices.data() + meshlet.vertexOffset;
+  Culling c;
+
+  for (index_t i = 0; i < meshlet.vertexCount; ++i)
+    c.bounds.inflate(positions[indices[i]]);
+  c.center = 0.5f * (c.bounds.min() + c.bounds.max());
+  c.radius = 0;
+  for (index_t i = 0; i < meshlet.vertexCount; ++i)
+  {
+    auto d = positions[indices[i]] - c.center;
+    c.radius = std::max(c.radius, d.length());
+  }
+
+  auto meshTriangles = triangleIndices.data() + meshlet.triangleOffset;
+  auto normal = [&](index_t t)
+  {
+    auto& triangle = _data->triangle(t);
+    auto v0 = positions[triangle.i];
+    auto n = cross(positions[triangle.j] - v0, positions[triangle.k] - v0);
+    auto length = n.length();
+
+    return length > 0 ? (1 / length) * n : vec3{0, 0, 0};
+  };
+
+  c.axis = {0, 0, 0};
+  for (index_t i = 0; i < meshlet.triangleCount; ++i)
+    c.axis = c.axis + normal(meshTriangles[i]);
+
+  auto length = c.axis.length();
+
+  c.cutoff = -1;
+  if (length > 0)
+  {
+    c.axis = (1 / length) * c.axis;
+    c.cutoff = 1;
+    for (index_t i = 0; i < meshlet.triangleCount; ++i)
+      c.cutoff = std::min(c.cutoff, dot(normal(meshTriangles[i]), c.axis));
+  }
+  culling.push_back(c);
+}
+
+void
+Region::build(const TriangleMesh& mesh)
+{
+  auto& adjacency = mesh.adjacency();
+
+  _data = &mesh.data();
+  _used.assign(end - begin, 0);
+
+  auto unused = [this](index_t t)
+  {
+    return t >= begin && t < end && !_used[t - begin];
+  };
+  auto last = none;
+
+  for (auto cursor = begin;;)
+  {
+    auto best = none;
+    unsigned bestScore = 4;
+    auto search = [&](index_t v)
+    {
+      for (auto t : adjacency.triangles(v))
+        if (unused(t))
+          if (auto score = newVertices(t); score < bestScore)
+          {
+            best = t;
+            bestScore = score;
+          }
+    };
+
+    if (last != none)
+    {
+      auto& triangle = _data->triangle(last);
+
+      search(triangle.i);
+      search(triangle.j);
+      search(triangle.k);
+      if (best == none)
+      {
+        auto& meshlet = meshlets.back();
+
+        for (index_t i = 0; i < meshlet.vertexCount; ++i)
+          search(vertices[meshlet.vertexOffset + i]);
+      }
+    }
+    if (best == none)
+    {
+      while (cursor < end && _used[cursor - begin])
+        ++cursor;
+      if (cursor == end)
+        break;
+      best = cursor;
+    }
+    if (last == none ||
+      meshlets.back().triangleCount == Meshlets::maxTriangles ||
+      meshlets.back().vertexCount + newVertices(best) > Meshlets::maxVertices)
+    {
+      if (last != none)
+        close();
+      meshlets.push_back({index_t(vertices.size()),
+        index_t(triangles.size()),
+        0,
+        0});
+    }
+    add(best);
+    last = best;
+  }
+  if (last != none)
+    close();
+}
+
+} // end namespace
+
+Meshlets::Meshlets(const TriangleMesh& mesh):
+  _mesh{&mesh}
+{
+  auto nt = mesh.data().triangleCount();
+  auto regionCount = (nt + regionSize - 1) / regionSize;
+  std::vector<Region> regions(regionCount);
+  std::atomic<index_t> next{0};
+
+  // Built once, before the threads share it
+  (void)mesh.adjacency();
+  parallelRun(std::min(threadCount(), regionCount), [&](unsigned)
+  {
+    for (index_t r; (r = next++) < regionCount;)
+    {
+      auto& region = regions[r];
+
+      region.begin = r * regionSize;
+      region.end = std::min(nt, region.begin + regionSize);
+      region.build(mesh);
+    }
+  });
+
+  size_t meshletCount = 0;
+  size_t vertexCount = 0;
+
+  for (auto& region : regions)
+  {
+    meshletCount += region.meshlets.size();
+    vertexCount += region.vertices.size();
+  }
+  _meshlets.reserve(meshletCount);
+  _culling.reserve(meshletCount);
+  _vertices.reserve(vertexCount);
+  _triangles.reserve(nt);
+  _triangleIndices.reserve(nt);
+  for (auto& region : regions)
+  {
+    auto vertexOffset = index_t(_vertices.size());
+    auto triangleOffset = index_t(_triangles.size());
+
+    for (auto m : region.meshlets)
+    {
+      m.vertexOffset += vertexOffset;
+      m.triangleOffset += triangleOffset;
+      _meshlets.push_back(m);
+    }
+    _culling.insert(_culling.end(), region.culling.begin(), region.culling.end());
+    _vertices.insert(_vertices.end(), region.vertices.begin(), region.vertices.end());
+    _triangles.insert(_triangles.end(),
+      region.triangles.begin(),
+      region.triangles.end());
+    _triangleIndices.insert(_triangleIndices.end(),
+      region.triangleIndices.begin(),
+      region.triangleIndices.end());
+  }
+}
+
+//
+// The triangles face away from eye if every direction from eye to a
+// point of the bounding sphere makes an angle of at least 90 degrees
+// with every normal of the cone (Wihlidal, Optimizing the graphics
+// pipeline with compute, 2016).
+//
+bool
+Meshlets::backfacing(index_t i, const vec3& eye) const
+{
+  auto& c = culling(i);
+
+  if (c.cutoff <= 0)
+    return false;
+
+  auto d = c.center - eye;
+  auto sine = std::sqrt(1 - c.cutoff * c.cutoff);
+
+  return dot(d, c.axis) >= sine * d.length() + c.radius;
+}
+
+} // end namespace tcii::cg
@@ -2,9 +2,17 @@
 #define _CRT_SECURE_NO_WARNINGS
 #endif // _MSC_VER
 
-#include "TriangleMesh.h"
+#include "OBJStream.h"
+#include "util/MappedFile.h"
+#include "util/Parallel.h"
+#include <atomic>
+#include <charconv>
+#include <cstring>
 #include <filesystem>
+#include <new>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace tcii::cg
 { // begin namespace tcii::cg
@@ -12,122 +20,627 @@ namespace tcii::cg
 namespace
 { // begin namespace
 
-auto
-readMeshSize(FILE* file)
+//
+// Growable array whose storage can be handed over to a mesh data
+// object. Capacity grows geometrically with realloc, which moves large
+// blocks by remapping pages instead of copying them.
+//
+template <typename T>
+class Buffer
+{
+public:
+  Buffer() = default;
+
+  Buffer(const Buffer&) = delete;
+  Buffer& operator =(const Buffer&) = delete;
+
+  ~Buffer()
+  {
+    std::free(_data);
+  }
+
+  auto size() const
+  {
+    return _size;
+  }
+
+  auto& operator [](size_t i)
+  {
+    assert(i < _size);
+    return _data[i];
+  }
+
+  auto& add()
+  {
+    if (_size == _capacity)
+      reserve(_capacity < 1024 ? 1024 : 2 * _capacity);
+    return _data[_size++];
+  }
+
+  void reserve(size_t capacity)
+  {
+    if (capacity <= _capacity)
+      return;
+
+    auto data = TriangleMesh::Data::reallocate(_data, capacity);
+
+    if (data == nullptr)
+      throw std::bad_alloc{};
+    _data = data;
+    _capacity = capacity;
+  }
+
+  // Shrinks the storage to the element count and releases it
+  auto release()
+  {
+    auto data = _data;
+
+    if (_size < _capacity)
+      data = TriangleMesh::Data::reallocate(data, _size);
+    _data = nullptr;
+    _size = _capacity = 0;
+    return data;
+  }
+
+private:
+  T* _data{};
+  size_t _size{};
+  size_t _capacity{};
+
+}; // Buffer
+
+using VertexBuffer = Buffer<TriangleMesh::vec3>;
+using TriangleBuffer = Buffer<TriangleMesh::Triangle>;
+
+//
+// Tokenizer for OBJ text held in memory. Numbers are converted in
+// place with std::from_chars; there are no per-line library calls
+// and no limit on the line length.
+//
+class Parser
+{
+public:
+  Parser(const char* begin, const char* end):
+    _p{begin},
+    _end{end}
+  {
+    // do nothing
+  }
+
+  bool eof() const
+  {
+    return _p >= _end;
+  }
+
+  auto position() const
+  {
+    return _p;
+  }
+
+  // Returns the first character of the current line and skips it,
+  // unless the line is empty; the newline is left for skipLine()
+  char command()
+  {
+    auto c = *_p;
+
+    if (c != '\n')
+      ++_p;
+    return c;
+  }
+
+  bool blank() const
+  {
+    return _p < _end && isBlank(*_p);
+  }
+
+  void skipLine()
+  {
+    while (_p < _end && *_p++ != '\n')
+      ;
+  }
+
+  bool readFloat(float& x)
+  {
+    skipBlanks();
+    if (_p < _end && *_p == '+')
+      ++_p;
+
+    auto [p, ec] = std::from_chars(_p, _end, x);
+
+    if (p == _p)
+      return false;
+    _p = p;
+    return ec == std::errc{};
+  }
+
+  // Reads the vertex index of a face vertex (v, v/t, v//n or v/t/n)
+  bool readIndex(long& v)
+  {
+    skipBlanks();
+
+    auto [p, ec] = std::from_chars(_p, _end, v);
+
+    if (ec != std::errc{})
+      return false;
+    for (_p = p; _p < _end && !isBlank(*_p) && *_p != '\n'; ++_p)
+      ;
+    return true;
+  }
+
+private:
+  const char* _p;
+  const char* _end;
+
+  static bool isBlank(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  void skipBlanks()
+  {
+    while (_p < _end && isBlank(*_p))
+      ++_p;
+  }
+
+}; // Parser
+
+//
+// Output of a single-pass read: records are appended to growable
+// buffers
+//
+struct MeshBuffers
+{
+  VertexBuffer vertices;
+  TriangleBuffer triangles;
+
+  auto vertexCount() const
+  {
+    return vertices.size();
+  }
+
+  auto& addVertex()
+  {
+    return vertices.add();
+  }
+
+  auto& addTriangle()
+  {
+    return triangles.add();
+  }
+
+}; // MeshBuffers
+
+//
+// Output of a chunk whose record counts are known in advance: records
+// are written in place into the final mesh arrays
+//
+struct MeshArrays
+{
+  TriangleMesh::vec3* vertices;
+  TriangleMesh::Triangle* triangles;
+  size_t vertexBase; // index of vertices[0] in the mesh
+  size_t vid{};
+  size_t tid{};
+
+  auto vertexCount() const
+  {
+    return vertexBase + vid;
+  }
+
+  auto& addVertex()
+  {
+    return vertices[vid++];
+  }
+
+  auto& addTriangle()
+  {
+    return triangles[tid++];
+  }
+
+}; // MeshArrays
+
+//
+// Reads the record at the start of the current line
+//
+template <typename Output>
+void
+readLine(Parser& parser, Output& output)
 {
   using index_t = TriangleMesh::index_t;
 
-  constexpr auto maxSize = 256;
-  index_t nv{};
-  index_t nt{};
-  char buffer[maxSize];
+  switch (parser.command())
+  {
+    case 'v':
+      if (parser.blank())
+      {
+        auto& p = output.addVertex();
+
+        p = {0, 0, 0};
+        (void)(parser.readFloat(p.x) &&
+          parser.readFloat(p.y) &&
+          parser.readFloat(p.z));
+      }
+      break;
 
-  while (char* line = fgets(buffer, maxSize, file))
-    switch (*line++)
+    case 'f':
     {
-      case 'v':
-        if (*line == ' ')
-          nv++;
-        break;
+      auto nv = (long)output.vertexCount();
+      long v;
+      index_t nfv{};
+      TriangleMesh::Triangle triangle;
 
-      case 'f':
+      // This version reads vertex coordinates only and
+      // ignores vertex texture coordinates and normals.
+      // Polygons are split into a triangle fan around their
+      // first vertex; negative indices are relative to the
+      // end of the vertex list read so far
+      for (; parser.readIndex(v); ++nfv)
       {
-        index_t v;
-        index_t n;
-        index_t t;
-        index_t nfv{};
+        auto i = index_t(v < 0 ? nv + v : v - 1);
 
-        for (;; ++nfv)
+        if (nfv < 3)
+          triangle[nfv] = i;
+        else
         {
-          while (*line == ' ')
-            line++;
-          if (sscanf(line, "%d/%d/%d", &v, &t, &n) <= 0)
-            break;
-          while (*line && *line != ' ')
-            ++line;
+          triangle.j = triangle.k;
+          triangle.k = i;
+          output.addTriangle() = triangle;
         }
-        nt += nfv - 2;
-        break;
+        if (nfv == 2)
+          output.addTriangle() = triangle;
       }
+      break;
     }
-  return std::pair{nv, nt};
+  }
 }
 
+template <typename Output>
 void
-readMeshData(FILE* file, TriangleMesh::Data& data)
+readMeshData(Parser& parser, Output& output)
 {
-  using index_t = TriangleMesh::index_t;
+  for (; !parser.eof(); parser.skipLine())
+    readLine(parser, output);
+}
 
-  constexpr auto maxSize = 256;
-  index_t vid{};
-  index_t tid{};
-  char buffer[maxSize];
+//
+// Counts the vertices and triangles readMeshData() would produce
+//
+auto
+countMeshData(Parser& parser)
+{
+  size_t nv{};
+  size_t nt{};
 
-  while (char* line = fgets(buffer, maxSize, file))
-    switch (*line++)
+  for (; !parser.eof(); parser.skipLine())
+    switch (parser.command())
     {
       case 'v':
-        if (*line == ' ')
-        {
-          float x;
-          float y;
-          float z;
-
-          (void)sscanf(line + 1, "%f %f %f", &x, &y, &z);
-          data.vertex(vid++) = {x, y, z};
-        }
+        if (parser.blank())
+          nv++;
         break;
 
       case 'f':
       {
-        index_t v;
-        index_t n;
-        index_t t;
-        auto& triangle = data.triangle(tid);
-
-        // This version reads vertex coordinates only and
-        // ignores vertex texture coordinates and normals
-        for (index_t i{};; ++i)
-        {
-          while (*line == ' ')
-            line++;
-          if (sscanf(line, "%d/%d/%d", &v, &t, &n) <= 0)
-            break;
-          if (i < 3)
-            triangle[i] = v - 1;
-          else
-            data.triangle(++tid).set(triangle.i, triangle.k, v - 1);
-          while (*line && *line != ' ')
-            ++line;
-        }
-        ++tid;
+        long v;
+        size_t nfv{};
+
+        while (parser.readIndex(v))
+          nfv++;
+        if (nfv >= 3)
+          nt += nfv - 2;
         break;
       }
     }
+  return std::pair{nv, nt};
+}
+
+// Files smaller than this per chunk are read by a single thread
+constexpr size_t minChunkSize = 4 << 20;
+
+//
+// Makes a mesh of the arrays, whose ownership it takes. Returns null
+// if a face refers to a vertex that does not exist.
+//
+TriangleMesh*
+makeMesh(size_t nv, size_t nt, TriangleMesh::vec3* v, TriangleMesh::Triangle* t)
+{
+  using index_t = TriangleMesh::index_t;
+
+  std::atomic<bool> valid{true};
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = b; i < e; ++i)
+      if (t[i].i >= nv || t[i].j >= nv || t[i].k >= nv)
+      {
+        valid.store(false, std::memory_order_relaxed);
+        return;
+      }
+  });
+  if (!valid)
+  {
+    fprintf(stderr, "Face vertex index out of range\n");
+    std::free(v);
+    std::free(t);
+    return nullptr;
+  }
+
+  TriangleMesh::Data data{(index_t)nv, v, (index_t)nt, t};
+
+  return new TriangleMesh{std::move(data)};
+}
+
+TriangleMesh*
+readMesh(const char* begin, const char* end)
+{
+  Parser parser{begin, end};
+  MeshBuffers output;
+
+  readMeshData(parser, output);
+
+  auto nv = output.vertices.size();
+  auto nt = output.triangles.size();
+
+  if (nv < 3 || nt < 1)
+    return nullptr;
+  return makeMesh(nv,
+    nt,
+    output.vertices.release(),
+    output.triangles.release());
+}
+
+//
+// Splits the text into newline-aligned chunks, one per thread. Each
+// chunk counts its records; a prefix sum over the counts gives the
+// offsets where the chunks write their records in the mesh arrays.
+//
+TriangleMesh*
+readMesh(const char* begin, const char* end, unsigned chunkCount)
+{
+  std::vector<const char*> bounds(chunkCount + 1);
+  auto size = size_t(end - begin);
+
+  bounds[0] = begin;
+  bounds[chunkCount] = end;
+  for (auto k = 1u; k < chunkCount; ++k)
+  {
+    auto p = std::max(begin + size * k / chunkCount, bounds[k - 1]);
+
+    while (p < end && p[-1] != '\n')
+      ++p;
+    bounds[k] = p;
+  }
+
+  std::vector<std::pair<size_t, size_t>> offsets(chunkCount + 1);
+
+  parallelRun(chunkCount, [&](unsigned k)
+  {
+    Parser parser{bounds[k], bounds[k + 1]};
+
+    offsets[k + 1] = countMeshData(parser);
+  });
+  for (auto k = 1u; k <= chunkCount; ++k)
+  {
+    offsets[k].first += offsets[k - 1].first;
+    offsets[k].second += offsets[k - 1].second;
+  }
+
+  auto [nv, nt] = offsets[chunkCount];
+
+  if (nv < 3 || nt < 1)
+    return nullptr;
+
+  using Data = TriangleMesh::Data;
+
+  auto vertices = Data::allocate<TriangleMesh::vec3>(nv);
+  auto triangles = Data::allocate<TriangleMesh::Triangle>(nt);
+
+  if (vertices == nullptr || triangles == nullptr)
+  {
+    std::free(vertices);
+    std::free(triangles);
+    throw std::bad_alloc{};
+  }
+  parallelRun(chunkCount, [&](unsigned k)
+  {
+    Parser parser{bounds[k], bounds[k + 1]};
+    auto [vid, tid] = offsets[k];
+    MeshArrays output{vertices + vid, triangles + tid, vid};
+
+    readMeshData(parser, output);
+  });
+  return makeMesh(nv, nt, vertices, triangles);
+}
+
+void
+weld(TriangleMesh& mesh, float epsilon)
+{
+  auto result = mesh.weld(epsilon);
+
+  printf("Welded %u vertices, dropped %u triangles (%zu bytes saved)\n",
+    result.vertices,
+    result.triangles,
+    result.bytes);
 }
 
 } // end namespace
 
 ObjectPtr<TriangleMesh>
-readOBJ(const char* filename)
+readOBJ(const char* filename, float weldEpsilon)
 {
-  FILE* file = fopen(filename, "r");
+  // A binary cache is kept next to the OBJ file and rebuilt whenever
+  // the OBJ file changes. Each weld epsilon has a cache of its own,
+  // named after the exact (hexadecimal) epsilon, which holds the mesh
+  // already welded
+  auto welding = weldEpsilon >= 0;
+  std::string cacheName{filename};
+
+  if (welding)
+  {
+    char epsilon[32];
+
+    snprintf(epsilon, sizeof epsilon, "%a", weldEpsilon);
+    cacheName += ".welded-";
+    cacheName += epsilon;
+  }
+  cacheName += ".cache";
+  if (auto mesh = readMeshCache(cacheName.c_str(), filename))
+  {
+    printf("Reading mesh cache %s...\n", cacheName.c_str());
+    return mesh;
+  }
+
+  auto file = MappedFile::New(filename);
 
   if (file == nullptr)
     return nullptr;
 
-  auto [nv, nt] = readMeshSize(file);
-  TriangleMesh::Data data{nv, nt};
+  auto begin = file->data();
+  auto end = begin + file->size();
+  auto chunkCount = (unsigned)std::min<size_t>(threadCount(),
+    file->size() / minChunkSize);
 
-  rewind(file);
   printf("Reading Wavefront OBJ file %s...\n", filename);
-  readMeshData(file, data);
-  fclose(file);
 
-  auto mesh = new TriangleMesh{std::move(data)};
+  ObjectPtr<TriangleMesh> mesh;
 
-  mesh->computeVertexNormals();
+  if (chunkCount > 1)
+    mesh = readMesh(begin, end, chunkCount);
+  else
+  {
+    file->adviseSequential();
+    mesh = readMesh(begin, end);
+  }
+  if (mesh != nullptr)
+  {
+    if (welding)
+      weld(*mesh, weldEpsilon);
+    mesh->computeVertexNormals();
+    if (!writeMeshCache(*mesh, cacheName.c_str(), filename))
+      fprintf(stderr, "Could not write mesh cache %s\n", cacheName.c_str());
+  }
   return mesh;
 }
 
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// OBJStream implementation
+// ========
+struct OBJStreamOutput
+{
+  OBJStream& stream;
+
+  auto vertexCount() const
+  {
+    return stream.vertexCount();
+  }
+
+  auto& addVertex()
+  {
+    return stream._vertices.emplace_back();
+  }
+
+  auto& addTriangle()
+  {
+    return stream._triangles.emplace_back();
+  }
+
+}; // OBJStreamOutput
+
+OBJStream::OBJStream(FILE* file, size_t batchSize):
+  _file{file},
+  _batchSize{std::max<size_t>(batchSize, 1)},
+  _buffer(1 << 20)
+{
+  _vertices.reserve(_batchSize);
+  _triangles.reserve(_batchSize);
+}
+
+OBJStream::~OBJStream()
+{
+  fclose(_file);
+}
+
+ObjectPtr<OBJStream>
+OBJStream::New(const char* filename, size_t batchSize)
+{
+  auto file = fopen(filename, "rb");
+
+  if (file == nullptr)
+    return nullptr;
+  return new OBJStream{file, batchSize};
+}
+
+//
+// Makes sure the buffer holds at least one complete line, reading
+// more of the file if needed. The buffer only grows if a single line
+// does not fit in it. Returns false at end of file.
+//
+bool
+OBJStream::fill()
+{
+  if (_begin < _lineEnd)
+    return true;
+
+  auto data = _buffer.data();
+
+  memmove(data, data + _begin, _end -= _begin);
+  _begin = 0;
+  for (auto scanned = size_t(0);;)
+  {
+    for (auto p = _end; p > scanned; --p)
+      if (data[p - 1] == '\n')
+      {
+        _lineEnd = p;
+        return true;
+      }
+    if (_eof)
+    {
+      // Last line has no newline
+      _lineEnd = _end;
+      return _end > 0;
+    }
+    scanned = _end;
+    if (_end == _buffer.size())
+    {
+      _buffer.resize(2 * _buffer.size());
+      data = _buffer.data();
+    }
+    _end += fread(data + _end, 1, _buffer.size() - _end, _file);
+    _eof = feof(_file) || ferror(_file);
+  }
+}
+
+bool
+OBJStream::next(Batch& batch)
+{
+  _vertexBase += (index_t)_vertices.size();
+  _triangleBase += (index_t)_triangles.size();
+  _vertices.clear();
+  _triangles.clear();
+
+  OBJStreamOutput output{*this};
+  auto full = [this]()
+  {
+    return _vertices.size() >= _batchSize || _triangles.size() >= _batchSize;
+  };
+
+  while (!full() && fill())
+  {
+    auto data = _buffer.data();
+    Parser parser{data + _begin, data + _lineEnd};
+
+    for (; !parser.eof() && !full(); parser.skipLine())
+      readLine(parser, output);
+    _begin = parser.position() - data;
+  }
+  batch.vertexBase = _vertexBase;
+  batch.vertices = {_vertices.data(), _vertices.size()};
+  batch.triangleBase = _triangleBase;
+  batch.triangles = {_triangles.data(), _triangles.size()};
+  return !_vertices.empty() || !_triangles.empty();
+}
+
 } // end namespace tcii::cg
@@ -0,0 +1,854 @@
+// OVERVIEW: Simplification.cpp
+// ========
+// Source file for quadric error mesh simplification.
+//
+// Last revision: 17/10/2026
+
+#include "Simplification.h"
+#include "util/Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <queue>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+using index_t = TriangleMesh::index_t;
+using vec3 = TriangleMesh::vec3;
+using dvec3 = Vec3<double>;
+
+constexpr auto none = ~index_t{};
+
+// Meshes are split into up to 2^maxPartitionDepth partitions, but not
+// into partitions smaller than minTrianglesPerPartition
+constexpr unsigned maxPartitionDepth = 4;
+constexpr index_t minTrianglesPerPartition = 1 << 15;
+
+// Owner of a vertex shared by several partitions (or by none)
+constexpr uint8_t noPartition = 0xff;
+constexpr unsigned allPartitions = ~0u;
+
+// Weight of the planes through boundary edges, relative to the
+// triangle areas, that keep the boundaries in place
+constexpr double boundaryWeight = 10;
+
+// Levels of detail keep at least this many triangles
+constexpr index_t minTriangleCount = 4;
+
+// Vertex flags
+constexpr uint8_t removedVertex = 1;
+constexpr uint8_t boundaryVertex = 2;
+
+inline dvec3
+toDouble(const vec3& p)
+{
+  return {p.x, p.y, p.z};
+}
+
+//
+// Quadric: symmetric 4x4 matrix Q such that the error of a point p is
+// [p 1] Q [p 1]^T, stored as its upper triangle
+// =======
+struct Quadric
+{
+  double a00{}, a01{}, a02{}, a03{};
+  double a11{}, a12{}, a13{};
+  double a22{}, a23{};
+  double a33{};
+
+  // Adds w times the squared distance to the plane n . p + d = 0,
+  // with n a unit vector
+  void addPlane(const dvec3& n, double d, double w)
+  {
+    a00 += w * n.x * n.x;
+    a01 += w * n.x * n.y;
+    a02 += w * n.x * n.z;
+    a03 += w * n.x * d;
+    a11 += w * n.y * n.y;
+    a12 += w * n.y * n.z;
+    a13 += w * n.y * d;
+    a22 += w * n.z * n.z;
+    a23 += w * n.z * d;
+    a33 += w * d * d;
+  }
+
+  Quadric& operator +=(const Quadric& q)
+  {
+    a00 += q.a00;
+    a01 += q.a01;
+    a02 += q.a02;
+    a03 += q.a03;
+    a11 += q.a11;
+    a12 += q.a12;
+    a13 += q.a13;
+    a22 += q.a22;
+    a23 += q.a23;
+    a33 += q.a33;
+    return *this;
+  }
+
+  double error(const dvec3& p) const
+  {
+    auto x = a00 * p.x + a01 * p.y + a02 * p.z + a03;
+    auto y = a01 * p.x + a11 * p.y + a12 * p.z + a13;
+    auto z = a02 * p.x + a12 * p.y + a22 * p.z + a23;
+    auto w = a03 * p.x + a13 * p.y + a23 * p.z + a33;
+
+    return std::max(0.0, x * p.x + y * p.y + z * p.z + w);
+  }
+
+  // Point of minimum error, if the 3x3 block is well conditioned
+  bool minimum(dvec3& p) const
+  {
+    auto c00 = a11 * a22 - a12 * a12;
+    auto c01 = a02 * a12 - a01 * a22;
+    auto c02 = a01 * a12 - a02 * a11;
+    auto det = a00 * c00 + a01 * c01 + a02 * c02;
+    auto trace = a00 + a11 + a22;
+
+    if (!(std::abs(det) > 1e-9 * trace * trace * trace))
+      return false;
+
+    auto c11 = a00 * a22 - a02 * a02;
+    auto c12 = a01 * a02 - a00 * a12;
+    auto c22 = a00 * a11 - a01 * a01;
+    auto s = -1 / det;
+
+    p.x = s * (c00 * a03 + c01 * a13 + c02 * a23);
+    p.y = s * (c01 * a03 + c11 * a13 + c12 * a23);
+    p.z = s * (c02 * a03 + c12 * a13 + c22 * a23);
+    return true;
+  }
+
+}; // Quadric
+
+inline Quadric
+operator +(Quadric q, const Quadric& r)
+{
+  return q += r;
+}
+
+// Collapse of vertex b into vertex a, valid while the stamps of a and
+// b do not change
+struct Collapse
+{
+  float cost;
+  index_t a;
+  index_t b;
+  uint32_t stampA;
+  uint32_t stampB;
+
+  bool operator >(const Collapse& other) const
+  {
+    return cost > other.cost;
+  }
+
+}; // Collapse
+
+using CollapseQueue =
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>;
+
+//
+// Simplifier: edge collapse state of a mesh
+// ==========
+// The triangles are kept as an array of corners (three vertices per
+// triangle), and the corners of each vertex are linked in a list, so
+// that merging the triangles of two vertices splices their lists. The
+// lists are compacted as they are walked. All arrays are indexed by
+// the vertices and triangles of the source mesh.
+//
+class Simplifier
+{
+public:
+  Simplifier(const TriangleMesh& mesh);
+
+  // Collapses edges until at most ratio * triangleCount triangles are
+  // left, or no valid collapse is left
+  void simplify(float ratio);
+
+  LevelOfDetail levelOfDetail() const;
+
+private:
+  // Working buffers of a thread
+  struct Scratch
+  {
+    std::vector<index_t> a;
+    std::vector<index_t> b;
+    float error{};
+
+  }; // Scratch
+
+  index_t _vertexCount;
+  index_t _triangleCount;
+  std::vector<vec3> _positions;
+  std::vector<Quadric> _quadrics;
+  std::vector<uint32_t> _stamps;
+  std::vector<uint8_t> _flags;
+  std::vector<index_t> _head;
+  std::vector<index_t> _tail;
+  std::vector<index_t> _corners;
+  std::vector<index_t> _next;
+  std::vector<uint8_t> _dead;
+  // Partition of each triangle and of each vertex whose triangles all
+  // lie in one partition
+  std::vector<uint8_t> _partitions;
+  std::vector<uint8_t> _owners;
+  // Initial and current number of live triangles of each partition
+  std::vector<index_t> _initialCounts;
+  std::vector<index_t> _counts;
+  float _error{};
+
+  void initQuadrics(const TriangleMesh& mesh);
+  void partition();
+  void updateOwners();
+
+  void neighbors(index_t v, std::vector<index_t>& vertices);
+  Collapse makeCollapse(index_t u, index_t v) const;
+  dvec3 position(index_t u, index_t v, double& cost) const;
+  bool flips(index_t v, index_t other, const dvec3& p) const;
+  index_t collapse(const Collapse& c,
+    unsigned partition,
+    CollapseQueue& queue,
+    Scratch& s);
+  void pushCollapses(index_t a,
+    unsigned partition,
+    CollapseQueue& queue,
+    Scratch& s);
+  void reduce(CollapseQueue& queue,
+    index_t count,
+    index_t target,
+    unsigned partition,
+    Scratch& s);
+
+  bool removed(index_t v) const
+  {
+    return _flags[v] & removedVertex;
+  }
+
+  bool owned(index_t v, unsigned partition) const
+  {
+    return partition == allPartitions || _owners[v] == partition;
+  }
+
+  auto partitionCount() const
+  {
+    return unsigned(_counts.size());
+  }
+
+}; // Simplifier
+
+Simplifier::Simplifier(const TriangleMesh& mesh):
+  _vertexCount{mesh.data().vertexCount()},
+  _triangleCount{mesh.data().triangleCount()},
+  _positions(_vertexCount),
+  _quadrics(_vertexCount),
+  _stamps(_vertexCount),
+  _flags(_vertexCount),
+  _head(_vertexCount, none),
+  _tail(_vertexCount, none),
+  _corners(3 * size_t(_triangleCount)),
+  _next(3 * size_t(_triangleCount), none),
+  _dead(_triangleCount),
+  _partitions(_triangleCount),
+  _owners(_vertexCount, noPartition)
+{
+  auto& data = mesh.data();
+  auto vertices = data.vertices();
+
+  parallelFor(_vertexCount, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = b; i < e; ++i)
+      _positions[i] = vertices[i];
+  });
+  for (index_t t = 0, c = 0; t < _triangleCount; ++t)
+  {
+    auto& triangle = data.triangle(t);
+
+    _corners[c] = triangle.i;
+    _corners[c + 1] = triangle.j;
+    _corners[c + 2] = triangle.k;
+    _dead[t] = triangle.i == triangle.j ||
+      triangle.j == triangle.k ||
+      triangle.k == triangle.i;
+    for (auto end = c + 3; c < end; ++c)
+    {
+      auto v = _corners[c];
+
+      if (_head[v] == none)
+        _head[v] = c;
+      else
+        _next[_tail[v]] = c;
+      _tail[v] = c;
+    }
+  }
+  initQuadrics(mesh);
+  partition();
+}
+
+//
+// Each vertex sums the quadrics of the planes of its triangles,
+// weighted by their areas, and of the planes through its boundary
+// edges perpendicular to their triangles. A boundary edge is shared
+// by a single triangle, so its other vertex occurs once among the
+// vertices of the triangles of the vertex.
+//
+void
+Simplifier::initQuadrics(const TriangleMesh& mesh)
+{
+  auto& adjacency = mesh.adjacency();
+
+  parallelFor(_vertexCount, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    std::vector<index_t> others;
+
+    for (auto v = index_t(b); v < e; ++v)
+    {
+      auto triangles = adjacency.triangles(v);
+      auto pv = toDouble(_positions[v]);
+      Quadric q;
+
+      others.clear();
+      for (auto t : triangles)
+      {
+        if (_dead[t])
+          continue;
+
+        auto c = _corners.data() + 3 * size_t(t);
+        auto n = cross(toDouble(_positions[c[1]]) - toDouble(_positions[c[0]]),
+          toDouble(_positions[c[2]]) - toDouble(_positions[c[0]]));
+        auto length = n.length();
+
+        for (int i = 0; i < 3; ++i)
+          if (c[i] != v)
+            others.push_back(c[i]);
+        if (length > 0)
+          q.addPlane((1 / length) * n, -dot(n, pv) / length, length / 2);
+      }
+      std::sort(others.begin(), others.end());
+      for (auto t : triangles)
+      {
+        if (_dead[t])
+          continue;
+
+        auto c = _corners.data() + 3 * size_t(t);
+
+        for (int i = 0; i < 3; ++i)
+        {
+          auto w = c[i];
+
+          if (w == v)
+            continue;
+
+          auto range = std::equal_range(others.begin(), others.end(), w);
+
+          if (range.second - range.first != 1)
+            continue;
+          _flags[v] |= boundaryVertex;
+
+          auto normal = cross(toDouble(_positions[c[1]]) - toDouble(_positions[c[0]]),
+            toDouble(_positions[c[2]]) - toDouble(_positions[c[0]]));
+          auto edge = toDouble(_positions[w]) - pv;
+          auto n = cross(edge, normal);
+          auto length = n.length();
+
+          if (length > 0)
+          {
+            n = (1 / length) * n;
+            q.addPlane(n, -dot(n, pv), boundaryWeight * dot(edge, edge));
+          }
+        }
+      }
+      _quadrics[v] = q;
+    }
+  });
+}
+
+//
+// Splits the triangles into 2^depth partitions of equal size by their
+// centroids, halving each partition across the longest axis of the
+// bounds of its centroids.
+//
+void
+Simplifier::partition()
+{
+  unsigned depth = 0;
+
+  while (depth < maxPartitionDepth &&
+    _triangleCount >> (depth + 1) >= minTrianglesPerPartition)
+    ++depth;
+  _counts.assign(size_t(1) << depth, 0);
+  if (depth > 0)
+  {
+    std::vector<vec3> centroids(_triangleCount);
+    std::vector<index_t> triangles(_triangleCount);
+
+    for (index_t t = 0; t < _triangleCount; ++t)
+    {
+      auto c = _corners.data() + 3 * size_t(t);
+
+      centroids[t] = _positions[c[0]] + _positions[c[1]] + _positions[c[2]];
+      triangles[t] = t;
+    }
+
+    auto split = [&](auto& split, index_t* b, index_t* e, unsigned d, unsigned p)
+      -> void
+    {
+      if (d == depth)
+      {
+        for (auto t = b; t != e; ++t)
+          _partitions[*t] = uint8_t(p);
+        return;
+      }
+
+      Bounds3f bounds;
+
+      for (auto t = b; t != e; ++t)
+        bounds.inflate(centroids[*t]);
+
+      auto size = bounds.max() - bounds.min();
+      int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+      auto m = b + (e - b) / 2;
+
+      std::nth_element(b, m, e, [&](index_t s, index_t t)
+      {
+        auto cs = centroids[s][axis];
+        auto ct = centroids[t][axis];
+
+        return cs < ct || (cs == ct && s < t);
+      });
+      split(split, b, m, d + 1, 2 * p);
+      split(split, m, e, d + 1, 2 * p + 1);
+    };
+
+    split(split, triangles.data(), triangles.data() + _triangleCount, 0, 0);
+  }
+  for (index_t t = 0; t < _triangleCount; ++t)
+    _counts[_partitions[t]] += !_dead[t];
+  _initialCounts = _counts;
+}
+
+// Appends to vertices the distinct vertices adjacent to v, in
+// increasing order, and drops the corners of dead triangles from the
+// list of v
+void
+Simplifier::neighbors(index_t v, std::vector<index_t>& vertices)
+{
+  vertices.clear();
+
+  auto last = none;
+
+  for (auto c = _head[v]; c != none; c = _next[c])
+  {
+    auto t = c / 3;
+
+    if (_dead[t])
+      continue;
+    if (last == none)
+      _head[v] = c;
+    else
+      _next[last] = c;
+    last = c;
+    for (auto i = 3 * t; i < 3 * t + 3; ++i)
+      if (_corners[i] != v)
+        vertices.push_back(_corners[i]);
+  }
+  if (last == none)
+    _head[v] = none;
+  else
+    _next[last] = none;
+  _tail[v] = last;
+  std::sort(vertices.begin(), vertices.end());
+  vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+}
+
+// Position of the vertex that replaces u and v, and its error. The
+// result does not depend on the order of u and v
+dvec3
+Simplifier::position(index_t u, index_t v, double& cost) const
+{
+  if (u > v)
+    std::swap(u, v);
+
+  auto q = _quadrics[u] + _quadrics[v];
+  dvec3 p;
+
+  if (q.minimum(p))
+  {
+    cost = q.error(p);
+    return p;
+  }
+
+  auto pu = toDouble(_positions[u]);
+  auto pv = toDouble(_positions[v]);
+  auto pm = 0.5 * (pu + pv);
+  auto eu = q.error(pu);
+  auto ev = q.error(pv);
+  auto em = q.error(pm);
+
+  if (em < eu && em < ev)
+  {
+    cost = em;
+    return pm;
+  }
+  cost = eu <= ev ? eu : ev;
+  return eu <= ev ? pu : pv;
+}
+
+// The vertex closer to the new position survives the collapse, so
+// that its attributes stand for the merged vertex
+Collapse
+Simplifier::makeCollapse(index_t u, index_t v) const
+{
+  double cost;
+  auto p = position(u, v, cost);
+  auto du = p - toDouble(_positions[u]);
+  auto dv = p - toDouble(_positions[v]);
+
+  if (dot(dv, dv) < dot(du, du))
+    std::swap(u, v);
+  return {float(cost), u, v, _stamps[u], _stamps[v]};
+}
+
+// Whether moving v to p flips a triangle of v that is not shared with
+// other
+bool
+Simplifier::flips(index_t v, index_t other, const dvec3& p) const
+{
+  auto pv = toDouble(_positions[v]);
+
+  for (auto c = _head[v]; c != none; c = _next[c])
+  {
+    auto t = c / 3;
+
+    if (_dead[t])
+      continue;
+
+    auto x = _corners[3 * t + (c + 1) % 3];
+    auto y = _corners[3 * t + (c + 2) % 3];
+
+    if (x == other || y == other)
+      continue;
+
+    auto px = toDouble(_positions[x]);
+    auto py = toDouble(_positions[y]);
+
+    if (dot(cross(px - pv, py - pv), cross(px - p, py - p)) < 0)
+      return true;
+  }
+  return false;
+}
+
+//
+// Merges b into a, unless the stamps of the collapse are out of date or
+// the collapse is invalid. A collapse is valid if the vertices adjacent
+// to both a and b are exactly the opposite vertices of the triangles
+// of edge ab (the link condition), it does not join two boundaries
+// through an interior edge and it flips no triangle. Returns the
+// number of triangles removed.
+//
+index_t
+Simplifier::collapse(const Collapse& c,
+  unsigned partition,
+  CollapseQueue& queue,
+  Scratch& s)
+{
+  auto a = c.a;
+  auto b = c.b;
+
+  if (_stamps[a] != c.stampA || _stamps[b] != c.stampB)
+    return 0;
+  neighbors(a, s.a);
+  neighbors(b, s.b);
+
+  index_t shared = 0;
+
+  for (auto i = _head[a]; i != none; i = _next[i])
+  {
+    auto t = i / 3;
+
+    shared += _corners[3 * t] == b ||
+      _corners[3 * t + 1] == b ||
+      _corners[3 * t + 2] == b;
+  }
+
+  size_t common = 0;
+
+  for (auto i = s.a.begin(), j = s.b.begin(); i != s.a.end() && j != s.b.end();)
+    if (*i < *j)
+      ++i;
+    else if (*j < *i)
+      ++j;
+    else
+      ++common, ++i, ++j;
+  if (shared == 0 || common > shared)
+    return 0;
+  if ((_flags[a] & _flags[b] & boundaryVertex) && shared != 1)
+    return 0;
+
+  double cost;
+  auto p = position(a, b, cost);
+
+  if (flips(a, b, p) || flips(b, a, p))
+    return 0;
+  _positions[a] = {float(p.x), float(p.y), float(p.z)};
+  _quadrics[a] += _quadrics[b];
+  _flags[a] |= _flags[b] & boundaryVertex;
+  _flags[b] |= removedVertex;
+  ++_stamps[a];
+  ++_stamps[b];
+
+  index_t count = 0;
+
+  for (auto i = _head[b]; i != none; i = _next[i])
+  {
+    auto t = i / 3;
+
+    if (_corners[3 * t] == a || _corners[3 * t + 1] == a || _corners[3 * t + 2] == a)
+    {
+      _dead[t] = 1;
+      --_counts[_partitions[t]];
+      ++count;
+    }
+    else
+      _corners[i] = a;
+  }
+  _next[_tail[a]] = _head[b];
+  _tail[a] = _tail[b];
+  _head[b] = _tail[b] = none;
+  s.error = std::max(s.error, float(cost));
+  pushCollapses(a, partition, queue, s);
+  return count;
+}
+
+void
+Simplifier::pushCollapses(index_t a,
+  unsigned partition,
+  CollapseQueue& queue,
+  Scratch& s)
+{
+  neighbors(a, s.a);
+  for (auto v : s.a)
+    if (owned(v, partition))
+      queue.push(makeCollapse(a, v));
+}
+
+void
+Simplifier::reduce(CollapseQueue& queue,
+  index_t count,
+  index_t target,
+  unsigned partition,
+  Scratch& s)
+{
+  while (count > target && !queue.empty())
+  {
+    auto c = queue.top();
+
+    queue.pop();
+    count -= collapse(c, partition, queue, s);
+  }
+}
+
+// A vertex is owned by a partition if all its triangles are in it
+void
+Simplifier::updateOwners()
+{
+  parallelFor(_vertexCount, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto v = b; v < e; ++v)
+    {
+      auto owner = noPartition;
+
+      for (auto c = _head[v]; c != none; c = _next[c])
+      {
+        auto t = c / 3;
+
+        if (_dead[t])
+          continue;
+        if (owner == noPartition)
+          owner = _partitions[t];
+        else if (owner != _partitions[t])
+        {
+          owner = noPartition;
+          break;
+        }
+      }
+      _owners[v] = owner;
+    }
+  });
+}
+
+void
+Simplifier::simplify(float ratio)
+{
+  auto m = partitionCount();
+
+  if (m > 1)
+  {
+    updateOwners();
+
+    // Owned vertices of each partition
+    std::vector<index_t> offsets(m + 1);
+    std::vector<index_t> vertices(_vertexCount);
+
+    for (index_t v = 0; v < _vertexCount; ++v)
+      if (_owners[v] != noPartition)
+        ++offsets[_owners[v] + 1];
+    for (unsigned p = 0; p < m; ++p)
+      offsets[p + 1] += offsets[p];
+    for (index_t v = 0, i; v < _vertexCount; ++v)
+      if ((i = _owners[v]) != noPartition)
+        vertices[offsets[i]++] = v;
+    for (auto p = m; p > 0; --p)
+      offsets[p] = offsets[p - 1];
+    offsets[0] = 0;
+
+    std::atomic<unsigned> next{0};
+    std::vector<float> errors(m);
+
+    parallelRun(std::min(threadCount(), m), [&](unsigned)
+    {
+      Scratch s;
+
+      for (unsigned p; (p = next++) < m;)
+      {
+        auto target = index_t(ratio * _initialCounts[p]);
+        std::vector<Collapse> collapses;
+
+        if (_counts[p] <= target)
+          continue;
+        for (auto i = offsets[p]; i < offsets[p + 1]; ++i)
+        {
+          auto v = vertices[i];
+
+          neighbors(v, s.a);
+          for (auto u : s.a)
+            if (u > v && _owners[u] == p)
+              collapses.push_back(makeCollapse(v, u));
+        }
+
+        CollapseQueue queue{std::greater<Collapse>{}, std::move(collapses)};
+
+        s.error = 0;
+        reduce(queue, _counts[p], target, p, s);
+        errors[p] = s.error;
+      }
+    });
+    for (auto error : errors)
+      _error = std::max(_error, error);
+  }
+
+  index_t count = 0;
+  index_t initialCount = 0;
+
+  for (unsigned p = 0; p < m; ++p)
+  {
+    count += _counts[p];
+    initialCount += _initialCounts[p];
+  }
+
+  auto target = std::max(index_t(ratio * initialCount), minTriangleCount);
+
+  if (count <= target)
+    return;
+
+  // Collapses of the edges left, gathered block by block in vertex
+  // order
+  std::vector<std::vector<Collapse>> blocks(blockCount(_vertexCount,
+    minVerticesPerBlock));
+
+  parallelFor(_vertexCount, minVerticesPerBlock, [&](size_t b, size_t e, unsigned k)
+  {
+    std::vector<index_t> adjacent;
+
+    for (auto v = index_t(b); v < e; ++v)
+    {
+      if (removed(v))
+        continue;
+      neighbors(v, adjacent);
+      for (auto u : adjacent)
+        if (u > v)
+          blocks[k].push_back(makeCollapse(v, u));
+    }
+  });
+
+  std::vector<Collapse> collapses;
+
+  for (auto& block : blocks)
+    collapses.insert(collapses.end(), block.begin(), block.end());
+
+  CollapseQueue queue{std::greater<Collapse>{}, std::move(collapses)};
+  Scratch s;
+
+  reduce(queue, count, target, allPartitions, s);
+  _error = std::max(_error, s.error);
+}
+
+LevelOfDetail
+Simplifier::levelOfDetail() const
+{
+  std::vector<index_t> index(_vertexCount, none);
+  index_t nt = 0;
+
+  for (index_t t = 0; t < _triangleCount; ++t)
+    if (!_dead[t])
+    {
+      ++nt;
+      for (auto c = 3 * t; c < 3 * t + 3; ++c)
+        index[_corners[c]] = 0;
+    }
+
+  LevelOfDetail lod;
+
+  for (index_t v = 0; v < _vertexCount; ++v)
+    if (index[v] != none)
+    {
+      index[v] = index_t(lod.vertexMap.size());
+      lod.vertexMap.push_back(v);
+    }
+
+  auto nv = index_t(lod.vertexMap.size());
+  TriangleMesh::Data data{nv, nt};
+
+  for (index_t i = 0; i < nv; ++i)
+    data.vertex(i) = _positions[lod.vertexMap[i]];
+  for (index_t t = 0, i = 0; t < _triangleCount; ++t)
+    if (!_dead[t])
+    {
+      auto c = _corners.data() + 3 * size_t(t);
+
+      data.triangle(i++) = {index[c[0]], index[c[1]], index[c[2]]};
+    }
+  lod.mesh = new TriangleMesh{std::move(data)};
+  lod.mesh->computeVertexNormals();
+  lod.error = _error;
+  return lod;
+}
+
+} // end namespace
+
+std::vector<LevelOfDetail>
+simplify(const TriangleMesh& mesh, const float* ratios, size_t count)
+{
+  std::vector<LevelOfDetail> lods;
+
+  if (count == 0)
+    return lods;
+
+  Simplifier simplifier{mesh};
+
+  lods.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    assert(i == 0 || ratios[i] <= ratios[i - 1]);
+    simplifier.simplify(ratios[i]);
+    lods.push_back(simplifier.levelOfDetail());
+  }
+  return lods;
+}
+
+} // end namespace tcii::cg
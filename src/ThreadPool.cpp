@@ -0,0 +1,198 @@
+// OVERVIEW: ThreadPool.cpp
+// ========
+// Source file for work-stealing thread pool.
+//
+// Last revision: 17/10/2026
+
+#include "util/Parallel.h"
+#include <algorithm>
+#include <iterator>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+// Pool and queue of the worker running on this thread, if any
+thread_local const ThreadPool* currentPool;
+thread_local unsigned currentQueue;
+
+} // end namespace
+
+thread_local const ThreadPool::Job* ThreadPool::_currentJob;
+
+ThreadPool&
+ThreadPool::instance()
+{
+  static ThreadPool pool{threadCount() - 1};
+  return pool;
+}
+
+ThreadPool::ThreadPool(unsigned workerCount):
+  _queues{new Queue[workerCount + 1]}
+{
+  _workers.reserve(workerCount);
+  for (auto k = 0u; k < workerCount; ++k)
+    _workers.emplace_back([this, k]()
+    {
+      work(k);
+    });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard lock{_sleepLock};
+    _stop = true;
+  }
+  _wakeup.notify_all();
+  for (auto& worker : _workers)
+    worker.join();
+}
+
+unsigned
+ThreadPool::queueIndex() const
+{
+  return currentPool == this ? currentQueue : workerCount();
+}
+
+void
+ThreadPool::push(const Range& range)
+{
+  auto& queue = _queues[queueIndex()];
+
+  {
+    std::lock_guard lock{queue.lock};
+    queue.ranges.push_back(range);
+  }
+  // A worker about to sleep either sees the range or is woken up
+  _queued.fetch_add(1);
+  if (_sleeping.load() != 0)
+  {
+    std::lock_guard lock{_sleepLock};
+    _wakeup.notify_one();
+  }
+}
+
+//
+// Takes a range from the back of the queue of this thread or from the
+// front of another queue. If job is not null, only ranges of job and of
+// the jobs nested in it are taken. The jobs of queued ranges are still
+// running, and so are their parents, so their chains can be walked.
+//
+bool
+ThreadPool::take(Range& range, const Job* job)
+{
+  if (_queued.load(std::memory_order_relaxed) == 0)
+    return false;
+
+  auto n = workerCount() + 1;
+  auto self = queueIndex();
+  auto matches = [job](const Range& r)
+  {
+    return job == nullptr || r.job->nestedIn(job);
+  };
+
+  for (auto i = 0u; i < n; ++i)
+  {
+    auto& queue = _queues[(self + i) % n];
+    std::lock_guard lock{queue.lock};
+    auto& ranges = queue.ranges;
+
+    if (i == 0)
+    {
+      auto r = std::find_if(ranges.rbegin(), ranges.rend(), matches);
+
+      if (r == ranges.rend())
+        continue;
+      range = *r;
+      ranges.erase(std::next(r).base());
+    }
+    else
+    {
+      auto r = std::find_if(ranges.begin(), ranges.end(), matches);
+
+      if (r == ranges.end())
+        continue;
+      range = *r;
+      ranges.erase(r);
+    }
+    _queued.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+void
+ThreadPool::execute(Range range)
+{
+  while (range.end - range.begin > 1)
+  {
+    auto middle = range.begin + (range.end - range.begin) / 2;
+
+    push({range.job, middle, range.end});
+    range.end = middle;
+  }
+
+  auto job = range.job;
+  auto outer = _currentJob;
+
+  _currentJob = job;
+  try
+  {
+    job->call(job->f, range.begin);
+  }
+  catch (...)
+  {
+    if (!job->failed.exchange(true))
+      job->error = std::current_exception();
+  }
+  _currentJob = outer;
+  // The job may be gone once the count reaches 0
+  job->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void
+ThreadPool::run(Job& job)
+{
+  if (job.pending == 0)
+    return;
+  job.parent = _currentJob;
+  execute({&job, 0, job.pending});
+  while (job.pending.load(std::memory_order_acquire) != 0)
+    if (Range range; take(range, &job))
+      execute(range);
+    else
+      std::this_thread::yield();
+  if (job.error)
+    std::rethrow_exception(job.error);
+}
+
+void
+ThreadPool::work(unsigned index)
+{
+  currentPool = this;
+  currentQueue = index;
+  for (;;)
+  {
+    if (Range range; take(range))
+    {
+      execute(range);
+      continue;
+    }
+
+    std::unique_lock lock{_sleepLock};
+
+    _sleeping.fetch_add(1);
+    _wakeup.wait(lock, [this]()
+    {
+      return _stop || _queued.load() != 0;
+    });
+    _sleeping.fetch_sub(1);
+    if (_stop && _queued.load() == 0)
+      return;
+  }
+}
+
+} // end namespace tcii::cg
@@ -3,10 +3,15 @@
 // Source file for triangle mesh.
 //
 // Author: Paulo Pagliosa
-// Last revision: 06/07/2025
+// Last revision: 17/10/2026
 
 #include "TriangleMesh.h"
+#include "MeshKernels.h"
+#include "util/Parallel.h"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <vector>
 
 namespace tcii::cg
 { // begin namespace tcii::cg
@@ -28,17 +33,6 @@ normalize(vec3& v)
   return v = v.versor();
 }
 
-template <typename vec3>
-inline auto
-cross(const vec3& u, const vec3& v)
-{
-  const auto x = u.y * v.z - u.z * v.y;
-  const auto y = u.z * v.x - u.x * v.z;
-  const auto z = u.x * v.y - u.y * v.x;
-
-  return vec3{x, y, z};
-}
-
 template <typename vec3>
 inline auto
 normal(const vec3& v0, const vec3& v1, const vec3& v2)
@@ -53,12 +47,6 @@ normal(const vec3* v, const TriangleMesh::Triangle& t)
   return normal(v[t.i], v[t.j], v[t.k]);
 }
 
-template <typename Bounds>
-auto empty(const Bounds& b)
-{
-  return b[0].x >= b[1].x || b[0].y >= b[1].y || b[0].z >= b[1].z;
-}
-
 } // end namespace
 
 TriangleMesh::Data::Data(index_t vertexSize, index_t triangleSize):
@@ -66,48 +54,505 @@ TriangleMesh::Data::Data(index_t vertexSize, index_t triangleSize):
   _triangleSize{triangleSize}
 {
   assert(vertexSize >= 3 && triangleSize >= 1);
-  _vertices = new vec3[vertexSize];
-  _triangles = new Triangle[triangleSize];
+  _vertices = allocate<vec3>(vertexSize);
+  _triangles = allocate<Triangle>(triangleSize);
+}
+
+TriangleMesh::Data::Data(index_t vertexSize,
+  vec3* vertices,
+  index_t triangleSize,
+  Triangle* triangles):
+  _vertexSize{vertexSize},
+  _triangleSize{triangleSize},
+  _vertices{vertices},
+  _triangles{triangles}
+{
+  assert(vertexSize >= 3 && triangleSize >= 1);
+  assert(vertices != nullptr && triangles != nullptr);
+}
+
+TriangleMesh::Data::Data(const SharedObject* storage,
+  index_t vertexSize,
+  vec3* vertices,
+  vec3* vertexNormals,
+  index_t triangleSize,
+  Triangle* triangles):
+  _vertexSize{vertexSize},
+  _triangleSize{triangleSize},
+  _vertices{vertices},
+  _vertexNormals{vertexNormals},
+  _triangles{triangles},
+  _storage{storage},
+  _storageArrays{vertices, vertexNormals, triangles}
+{
+  assert(vertexSize >= 3 && triangleSize >= 1);
+  assert(storage != nullptr);
+}
+
+TriangleMesh::Data::Data(Data&& other) noexcept:
+  _vertexSize{other._vertexSize},
+  _triangleSize{other._triangleSize},
+  _layout{other._layout},
+  _vertices{other._vertices},
+  _vertexNormals{other._vertexNormals},
+  _triangles{other._triangles},
+  _vertexColumns{std::move(other._vertexColumns)},
+  _normalColumns{std::move(other._normalColumns)},
+  _storage{other._storage},
+  _storageArrays{other._storageArrays[0],
+    other._storageArrays[1],
+    other._storageArrays[2]}
+{
+  other._vertices = nullptr;
+  other._vertexNormals = nullptr;
+  other._triangles = nullptr;
 }
 
 TriangleMesh::TriangleMesh(Data&& data):
-  _data{data}
+  _data{std::move(data)}
 {
-  data._vertices = nullptr;
-  data._vertexNormals = nullptr;
-  data._triangles = nullptr;
+  // do nothing
 }
 
 auto
-TriangleMesh::bounds() const -> Bounds&
+TriangleMesh::bounds() const -> Bounds
 {
-  if (empty(_bounds))
-    for (index_t i{}; i < _data._vertexSize; i++)
-      _bounds.inflate(_data._vertices[i]);
+  std::lock_guard lock{_lock};
+
+  if (_boundsValid)
+    return _bounds;
+
+  // Each thread reduces a block of vertices with the vector kernel;
+  // the block bounds are then merged
+  auto vertices = _data.vertices();
+  auto nv = vertices.size();
+  std::vector<Bounds> blocks(blockCount(nv, minVerticesPerBlock));
+
+  parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned k)
+  {
+    auto min = blocks[k].min();
+    auto max = blocks[k].max();
+
+    kernels::bounds(vertices.subview(b, e - b), min, max);
+    blocks[k].inflate(min);
+    blocks[k].inflate(max);
+  });
+  _bounds.setEmpty();
+  for (auto& block : blocks)
+    _bounds.inflate(block);
+  _boundsValid = true;
   return _bounds;
 }
 
+void
+TriangleMesh::setVertexLayout(VertexLayout layout)
+{
+  if (layout == _data._layout)
+    return;
+
+  auto nv = _data._vertexSize;
+  auto copy = [nv](Vec3Array from, Vec3View<float> to)
+  {
+    for (index_t i{}; i < nv; ++i)
+      to.ref(i) = from[i];
+  };
+
+  if (layout == VertexLayout::SoA)
+  {
+    _data._vertexColumns.reallocate(nv);
+    copy(_data.vertices(), Data::columns(_data._vertexColumns));
+    if (_data._vertexNormals != nullptr)
+    {
+      _data._normalColumns.reallocate(nv);
+      copy(_data.vertexNormals(), Data::columns(_data._normalColumns));
+    }
+    _data.release(_data._vertices);
+    _data.release(_data._vertexNormals);
+  }
+  else
+  {
+    auto vertices = Data::allocate<vec3>(nv);
+    vec3* normals{};
+
+    copy(_data.vertices(), {vertices, nv});
+    if (_data._normalColumns.size() != 0)
+    {
+      normals = Data::allocate<vec3>(nv);
+      copy(_data.vertexNormals(), {normals, nv});
+    }
+    _data._vertexColumns.reallocate(0);
+    _data._normalColumns.reallocate(0);
+    _data._vertices = vertices;
+    _data._vertexNormals = normals;
+  }
+  _data._layout = layout;
+}
+
+namespace
+{ // begin namespace
+
+// Minimum number of vertex normals updated by a thread
+constexpr size_t minVerticesPerNormalBlock = 1 << 12;
+
+// Vertex updates recompute all normals if they move at least
+// 1 / maxNormalUpdateRatio of the vertices
+constexpr size_t maxNormalUpdateRatio = 8;
+
+// Number of face normals computed per call to the vector kernel
+constexpr size_t normalTileSize = 256;
+
+// Vertex normals are gathered from the adjacency if the partial sums
+// of the blocks of triangles would span more than this many times the
+// number of vertices
+constexpr size_t maxPartialSpanRatio = 2;
+
+//
+// Adds the normal of each triangle to the sums of its vertices. The
+// sum of vertex v is stored at sums[v - first]. Face normals are
+// computed by the vector kernel a tile at a time and then scattered.
+//
+template <typename Triangle>
+void
+accumulateNormals(const kernels::PointColumns& points,
+  const Triangle* t,
+  size_t count,
+  const Vec3View<float>& sums,
+  size_t first = 0)
+{
+  float nx[normalTileSize];
+  float ny[normalTileSize];
+  float nz[normalTileSize];
+  auto sx = sums.x();
+  auto sy = sums.y();
+  auto sz = sums.z();
+  auto stride = sums.stride();
+
+  while (count > 0)
+  {
+    auto n = std::min(count, normalTileSize);
+
+    kernels::faceNormals(points, &t->i, n, nx, ny, nz);
+    for (size_t k = 0; k < n; ++k, ++t)
+      for (auto v : {t->i, t->j, t->k})
+      {
+        auto i = (v - first) * stride;
+
+        sx[i] += nx[k];
+        sy[i] += ny[k];
+        sz[i] += nz[k];
+      }
+    count -= n;
+  }
+}
+
+//
+// Sets the vectors of v in [first, last) to zero
+//
+void
+clear(const Vec3View<float>& v, size_t first, size_t last)
+{
+  if (auto a = v.data())
+    memset(a + first, 0, (last - first) * sizeof *a);
+  else
+    for (auto i = first; i < last; ++i)
+      v.x()[i] = v.y()[i] = v.z()[i] = 0;
+}
+
+} // end namespace
+
 void
 TriangleMesh::computeVertexNormals()
 {
   auto nv = _data._vertexSize;
+  auto nt = _data._triangleSize;
 
-  if (!_data._vertexNormals)
-    _data._vertexNormals = new vec3[nv];
-  memset(_data._vertexNormals, 0, nv * sizeof(vec3));
+  if (!_data.hasVertexNormals())
+  {
+    if (_data._layout == VertexLayout::SoA)
+      _data._normalColumns.reallocate(nv);
+    else
+      _data._vertexNormals = Data::allocate<vec3>(nv);
+  }
 
-  auto t = _data._triangles;
+  auto normals = _data.mutableVertexNormals();
+  auto points = _data.vertices();
+  auto m = blockCount(nt, minTrianglesPerBlock);
 
-  for (index_t i{}; i < _data._triangleSize; ++i, ++t)
+  if (m <= 1)
+  {
+    clear(normals, 0, nv);
+    accumulateNormals(points, _data._triangles, nt, normals);
+    kernels::normalize(normals);
+    return;
+  }
+
+  // Each thread accumulates the normals of a block of triangles into
+  // its own partial sums, which only span the range of vertices the
+  // block references (OBJ files are usually local enough for these
+  // ranges to be small). The partial sums are then reduced in block
+  // order, in parallel over vertex ranges, so there are no data races
+  // and the result does not depend on thread scheduling
+  struct Partial
   {
-    auto N = normal(_data._vertices, *t);
+    size_t first;
+    size_t last;
+    std::vector<vec3> sums;
+  };
 
-    _data._vertexNormals[t->i] += N;
-    _data._vertexNormals[t->j] += N;
-    _data._vertexNormals[t->k] += N;
+  std::vector<Partial> partials(m);
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned k)
+  {
+    auto t = _data._triangles + b;
+    auto first = (size_t)t->i;
+    auto last = first;
+
+    for (auto s = t; s != t + (e - b); ++s)
+      for (auto i : {s->i, s->j, s->k})
+      {
+        first = std::min<size_t>(first, i);
+        last = std::max<size_t>(last, i);
+      }
+    partials[k].first = first;
+    partials[k].last = last;
+  });
+
+  size_t span = 0;
+
+  for (auto& partial : partials)
+    span += partial.last - partial.first + 1;
+  if (span > maxPartialSpanRatio * nv)
+  {
+    // Reordering for the vertex cache scatters the vertices of a block
+    // over the whole mesh, so the spans would take several times the
+    // memory of the normals. The face normals are then computed once
+    // and each vertex sums those of its triangles, in triangle order
+    auto& adjacency = this->adjacency();
+    std::vector<float> faceNormals(3 * (size_t)nt);
+    auto nx = faceNormals.data();
+    auto ny = nx + nt;
+    auto nz = ny + nt;
+
+    parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+    {
+      kernels::faceNormals(points,
+        &_data._triangles[b].i,
+        e - b,
+        nx + b,
+        ny + b,
+        nz + b);
+    });
+    parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+    {
+      for (auto v = index_t(b); v < e; ++v)
+      {
+        vec3 n{0, 0, 0};
+
+        for (auto t : adjacency.triangles(v))
+          n += vec3{nx[t], ny[t], nz[t]};
+        normals.ref(v) = n;
+      }
+      kernels::normalize(normals.subview(b, e - b));
+    });
+    return;
   }
-  for (index_t i = 0; i < nv; ++i)
-    normalize(_data._vertexNormals[i]);
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned k)
+  {
+    auto& partial = partials[k];
+
+    partial.sums.resize(partial.last - partial.first + 1);
+    accumulateNormals(points,
+      _data._triangles + b,
+      e - b,
+      {partial.sums.data(), partial.sums.size()},
+      partial.first);
+  });
+  parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    clear(normals, b, e);
+    for (auto& partial : partials)
+    {
+      auto first = std::max(b, partial.first);
+      auto last = std::min(e - 1, partial.last);
+
+      for (auto i = first; i <= last; ++i)
+        normals.ref(i) = normals[i] + partial.sums[i - partial.first];
+    }
+    kernels::normalize(normals.subview(b, e - b));
+  });
+}
+
+//
+// The bounds grow to contain the new positions. They can only shrink if
+// a vertex on one of their faces moves inwards; they are then computed
+// again on the next call to bounds(). Vertex normals are recomputed
+// from the adjacency for the vertices of the triangles of the moved
+// vertices, unless these are many, in which case all normals are.
+//
+template <typename Id>
+void
+TriangleMesh::moveVertices(Id id, const vec3* positions, size_t count)
+{
+  auto vertices = _data.mutableVertices();
+
+  {
+    std::lock_guard lock{_lock};
+    auto boundsValid = _boundsValid;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto v = id(i);
+      auto p = positions[i];
+
+      if (boundsValid)
+      {
+        auto q = vertices[v];
+        auto& min = _bounds.min();
+        auto& max = _bounds.max();
+
+        for (int k = 0; k < 3; ++k)
+          if ((q[k] == min[k] && p[k] > q[k]) || (q[k] == max[k] && p[k] < q[k]))
+            boundsValid = false;
+        _bounds.inflate(p);
+      }
+      vertices.ref(v) = p;
+    }
+    _boundsValid = boundsValid;
+  }
+  if (!_data.hasVertexNormals() || count == 0)
+    return;
+  if (count >= _data._vertexSize / maxNormalUpdateRatio)
+  {
+    computeVertexNormals();
+    return;
+  }
+
+  auto& adjacency = this->adjacency();
+  std::vector<index_t> ring;
+
+  for (size_t i = 0; i < count; ++i)
+    for (auto t : adjacency.triangles(id(i)))
+    {
+      auto& triangle = _data._triangles[t];
+
+      ring.insert(ring.end(), {triangle.i, triangle.j, triangle.k});
+    }
+  std::sort(ring.begin(), ring.end());
+  ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+
+  auto normals = _data.mutableVertexNormals();
+
+  parallelFor(ring.size(), minVerticesPerNormalBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = b; i < e; ++i)
+    {
+      auto v = ring[i];
+      vec3 n{0, 0, 0};
+
+      // Unit face normals are added in triangle order, as in
+      // computeVertexNormals()
+      for (auto t : adjacency.triangles(v))
+      {
+        auto& triangle = _data._triangles[t];
+
+        n += normal(vertices[triangle.i],
+          vertices[triangle.j],
+          vertices[triangle.k]);
+      }
+      normals.ref(v) = n.versor();
+    }
+  });
+}
+
+void
+TriangleMesh::updateVertices(const index_t* ids,
+  const vec3* positions,
+  size_t count)
+{
+  moveVertices([ids](size_t i) { return ids[i]; }, positions, count);
+}
+
+void
+TriangleMesh::updateVertices(index_t first,
+  const vec3* positions,
+  size_t count)
+{
+  assert(first + count <= _data._vertexSize);
+  moveVertices([first](size_t i) { return index_t(first + i); },
+    positions,
+    count);
+}
+
+TriangleMesh::Adjacency::Adjacency(const Data& data):
+  _offsets(data._vertexSize + 1),
+  _triangles(3 * (size_t)data._triangleSize)
+{
+  auto nv = data._vertexSize;
+  auto nt = data._triangleSize;
+  auto triangles = data._triangles;
+  auto offsets = _offsets.data();
+
+  // Count the triangles of each vertex v into offsets[v + 1] and scan,
+  // so that offsets[v] is the start of the list of v
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto t = triangles + b; t != triangles + e; ++t)
+      for (auto v : {t->i, t->j, t->k})
+        std::atomic_ref{offsets[v + 1]}.fetch_add(1, std::memory_order_relaxed);
+  });
+  parallelInclusiveScan(offsets, (size_t)nv + 1);
+
+  // Fill the lists using offsets[v] as the insertion cursor of v. After
+  // that, offsets[v] is the end of the list of v, so shift the offsets
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = (index_t)b; i < e; ++i)
+    {
+      auto& t = triangles[i];
+
+      for (auto v : {t.i, t.j, t.k})
+      {
+        auto p = std::atomic_ref{offsets[v]}.fetch_add(1,
+          std::memory_order_relaxed);
+
+        _triangles[p] = i;
+      }
+    }
+  });
+  memmove(offsets + 1, offsets, nv * sizeof *offsets);
+  offsets[0] = 0;
+
+  // Threads fill a list in any order; sort the lists so the adjacency
+  // does not depend on scheduling
+  parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto v = b; v < e; ++v)
+      std::sort(_triangles.data() + offsets[v],
+        _triangles.data() + offsets[v + 1]);
+  });
+}
+
+auto
+TriangleMesh::adjacency() const -> const Adjacency&
+{
+  std::lock_guard lock{_lock};
+
+  if (_adjacency == nullptr)
+    _adjacency.reset(new Adjacency{_data});
+  return *_adjacency;
+}
+
+TriangleMesh::Observer::Observer(const TriangleMesh& mesh):
+  _mesh{&mesh}
+{
+  std::lock_guard lock{mesh._lock};
+  mesh._observers.push_back(this);
+}
+
+TriangleMesh::Observer::~Observer()
+{
+  std::lock_guard lock{_mesh->_lock};
+  std::erase(_mesh->_observers, this);
 }
 
 namespace
@@ -130,11 +575,11 @@ TriangleMesh::print(const char* s, FILE* f) const
   for (index_t i{}; i < _data._vertexSize; ++i)
   {
     fprintf(f, "    %d ", i);
-    printv(_data._vertices[i], f);
-    if (_data._vertexNormals != nullptr)
+    printv(_data.vertex(i), f);
+    if (_data.hasVertexNormals())
     {
       fputc('/', f);
-      printv(_data._vertexNormals[i], f);
+      printv(_data.vertexNormal(i), f);
     }
     fputc('\n', f);
   }
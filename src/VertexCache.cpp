@@ -0,0 +1,144 @@
+// OVERVIEW: VertexCache.cpp
+// ========
+// Source file for post-transform vertex cache optimization.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include <cstring>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+void
+TriangleMesh::reorderTriangles(const index_t* order)
+{
+  auto nt = _data._triangleSize;
+
+  if (nt == 0)
+    return;
+
+  auto triangles = Data::allocate<Triangle>(nt);
+
+  for (index_t i = 0; i < nt; ++i)
+    triangles[i] = _data._triangles[order[i]];
+  // Storage-backed triangles are mapped copy-on-write
+  memcpy(_data._triangles, triangles, nt * sizeof(Triangle));
+  std::free(triangles);
+  invalidateAdjacency();
+
+  for (auto observer : observers())
+    observer->trianglesReordered(order);
+}
+
+//
+// Tipsify (Sander, Nehab and Barczak, Fast triangle reordering for
+// vertex locality and reduced overdraw, 2007). The triangles around a
+// fanning vertex are emitted at once; the next fanning vertex is the
+// candidate that is likely to still be in the cache after its remaining
+// triangles are emitted. Dead ends fall back to the most recently
+// referenced vertex that has live triangles, then to the lowest index.
+//
+void
+TriangleMesh::optimizeVertexCache(unsigned cacheSize)
+{
+  constexpr auto none = ~index_t{};
+  auto nv = _data._vertexSize;
+  auto nt = _data._triangleSize;
+
+  if (nt == 0)
+    return;
+
+  auto& adjacency = this->adjacency();
+  std::vector<index_t> live(nv);
+  std::vector<index_t> time(nv);
+  std::vector<bool> emitted(nt);
+  std::vector<index_t> deadEnd;
+  std::vector<index_t> candidates;
+  std::vector<index_t> order;
+
+  for (index_t v = 0; v < nv; ++v)
+    live[v] = adjacency.degree(v);
+  order.reserve(nt);
+
+  auto stamp = index_t(cacheSize + 1);
+  index_t cursor = 0;
+
+  for (index_t f = 0; f != none;)
+  {
+    candidates.clear();
+    for (auto t : adjacency.triangles(f))
+    {
+      if (emitted[t])
+        continue;
+
+      auto& triangle = _data._triangles[t];
+
+      for (auto v : {triangle.i, triangle.j, triangle.k})
+      {
+        deadEnd.push_back(v);
+        candidates.push_back(v);
+        --live[v];
+        if (stamp - time[v] > cacheSize)
+          time[v] = stamp++;
+      }
+      emitted[t] = true;
+      order.push_back(t);
+    }
+    f = none;
+
+    // Prefer the candidate that entered the cache first among those
+    // whose remaining triangles do not push them out of it
+    long best = -1;
+
+    for (auto v : candidates)
+      if (live[v] > 0)
+      {
+        long priority = 0;
+
+        if (stamp - time[v] + 2 * live[v] <= cacheSize)
+          priority = stamp - time[v];
+        if (priority > best)
+        {
+          best = priority;
+          f = v;
+        }
+      }
+    while (f == none && !deadEnd.empty())
+    {
+      auto v = deadEnd.back();
+
+      deadEnd.pop_back();
+      if (live[v] > 0)
+        f = v;
+    }
+    for (; f == none && cursor < nv; ++cursor)
+      if (live[cursor] > 0)
+        f = cursor;
+  }
+  assert(order.size() == nt);
+  reorderTriangles(order.data());
+}
+
+float
+TriangleMesh::acmr(unsigned cacheSize) const
+{
+  auto nt = _data._triangleSize;
+
+  if (nt == 0)
+    return 0;
+
+  // time[v] is the number of misses after v entered the cache; v is
+  // evicted after cacheSize more misses
+  std::vector<index_t> time(_data._vertexSize);
+  index_t misses = 0;
+
+  for (auto& triangle : _data.triangles())
+    for (auto v : {triangle.i, triangle.j, triangle.k})
+      if (time[v] == 0 || misses - time[v] >= cacheSize)
+        time[v] = ++misses;
+  return float(misses) / nt;
+}
+
+} // end namespace tcii::cg
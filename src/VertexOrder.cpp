@@ -0,0 +1,195 @@
+// OVERVIEW: VertexOrder.cpp
+// ========
+// Source file for spatial vertex reordering.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include "util/Parallel.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+// Bits per Morton code coordinate and per radix sort pass
+constexpr unsigned mortonBits = 10;
+constexpr unsigned radixBits = 10;
+constexpr unsigned radixSize = 1 << radixBits;
+
+// Spreads the lower 10 bits of x so that there are two zero bits
+// between each of them
+inline uint32_t
+expandBits(uint32_t x)
+{
+  x = (x | x << 16) & 0x030000ff;
+  x = (x | x << 8) & 0x0300f00f;
+  x = (x | x << 4) & 0x030c30c3;
+  x = (x | x << 2) & 0x09249249;
+  return x;
+}
+
+inline uint32_t
+quantize(float x)
+{
+  constexpr auto max = float((1 << mortonBits) - 1);
+
+  // Also maps NaN to 0
+  return !(x > 0) ? 0 : x < max ? uint32_t(x) : uint32_t(max);
+}
+
+//
+// Stable LSD radix sort of (key, value) pairs. Each thread histograms a
+// block of keys per pass; the histograms are scanned digit by digit,
+// block by block, so every block scatters its keys to a disjoint range
+// and the result does not depend on the number of threads.
+//
+template <typename Value>
+void
+sortByKey(std::vector<uint32_t>& keys,
+  std::vector<Value>& values,
+  unsigned keyBits)
+{
+  auto n = keys.size();
+  auto m = blockCount(n, minVerticesPerBlock);
+  std::vector<uint32_t> sortedKeys(n);
+  std::vector<Value> sortedValues(n);
+  std::vector<size_t> offsets(m * radixSize);
+
+  for (unsigned shift = 0; shift < keyBits; shift += radixBits)
+  {
+    auto digit = [shift](uint32_t key)
+    {
+      return (key >> shift) & (radixSize - 1);
+    };
+
+    parallelFor(n, minVerticesPerBlock, [&](size_t b, size_t e, unsigned k)
+    {
+      auto count = offsets.data() + k * radixSize;
+
+      std::fill(count, count + radixSize, 0);
+      for (auto i = b; i < e; ++i)
+        ++count[digit(keys[i])];
+    });
+
+    size_t sum = 0;
+
+    for (unsigned d = 0; d < radixSize; ++d)
+      for (unsigned k = 0; k < m; ++k)
+      {
+        auto count = offsets[k * radixSize + d];
+
+        offsets[k * radixSize + d] = sum;
+        sum += count;
+      }
+    parallelFor(n, minVerticesPerBlock, [&](size_t b, size_t e, unsigned k)
+    {
+      auto offset = offsets.data() + k * radixSize;
+
+      for (auto i = b; i < e; ++i)
+      {
+        auto p = offset[digit(keys[i])]++;
+
+        sortedKeys[p] = keys[i];
+        sortedValues[p] = values[i];
+      }
+    });
+    keys.swap(sortedKeys);
+    values.swap(sortedValues);
+  }
+}
+
+} // end namespace
+
+void
+TriangleMesh::reorderVertices(const index_t* order)
+{
+  auto nv = _data._vertexSize;
+
+  // Gather through a temporary copy, so that the arrays are written in
+  // place in either layout (storage-backed arrays are copy-on-write)
+  auto permute = [&](Vec3View<float> a)
+  {
+    if (a.empty())
+      return;
+
+    std::vector<vec3> temp(nv);
+
+    parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+    {
+      for (auto i = b; i < e; ++i)
+        temp[i] = a[order[i]];
+    });
+    parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+    {
+      for (auto i = b; i < e; ++i)
+        a.ref(i) = temp[i];
+    });
+  };
+
+  permute(_data.mutableVertices());
+  permute(_data.mutableVertexNormals());
+
+  std::vector<index_t> index(nv);
+
+  for (index_t i = 0; i < nv; ++i)
+    index[order[i]] = i;
+
+  auto triangles = _data._triangles;
+
+  parallelFor(_data._triangleSize,
+    minTrianglesPerBlock,
+    [&](size_t b, size_t e, unsigned)
+    {
+      for (auto t = triangles + b; t != triangles + e; ++t)
+      {
+        t->i = index[t->i];
+        t->j = index[t->j];
+        t->k = index[t->k];
+      }
+    });
+  // The bounds do not change, but the adjacency is indexed by vertex
+  invalidateAdjacency();
+
+  for (auto observer : observers())
+    observer->verticesReordered(order);
+}
+
+std::vector<TriangleMesh::index_t>
+TriangleMesh::sortVertices()
+{
+  auto nv = _data._vertexSize;
+  auto bounds = this->bounds();
+  auto vertices = _data.vertices();
+  std::vector<uint32_t> codes(nv);
+  std::vector<index_t> order(nv);
+  vec3 scale;
+
+  // Each axis of the bounds is split into 2^mortonBits cells
+  for (int i = 0; i < 3; ++i)
+  {
+    auto size = bounds.max()[i] - bounds.min()[i];
+    scale[i] = size > 0 ? (1 << mortonBits) / size : 0;
+  }
+  parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto i = b; i < e; ++i)
+    {
+      auto p = vertices[i] - bounds.min();
+
+      codes[i] = expandBits(quantize(p.x * scale.x)) << 2 |
+        expandBits(quantize(p.y * scale.y)) << 1 |
+        expandBits(quantize(p.z * scale.z));
+      order[i] = index_t(i);
+    }
+  });
+  sortByKey(codes, order, 3 * mortonBits);
+  reorderVertices(order.data());
+  return order;
+}
+
+} // end namespace tcii::cg
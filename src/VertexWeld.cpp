@@ -0,0 +1,292 @@
+// OVERVIEW: VertexWeld.cpp
+// ========
+// Source file for vertex welding.
+//
+// Last revision: 17/10/2026
+
+#include "TriangleMesh.h"
+#include "util/Parallel.h"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace tcii::cg
+{ // begin namespace tcii::cg
+
+namespace
+{ // begin namespace
+
+using index_t = TriangleMesh::index_t;
+using vec3 = TriangleMesh::vec3;
+
+constexpr auto none = ~index_t{};
+
+// Minimum number of vertices searched by a thread; a search visits
+// the 27 cells around the vertex, so blocks are smaller than usual
+constexpr size_t minVerticesPerSearch = 1 << 14;
+
+// Key of a grid cell; never 0, which marks empty slots. Distinct cells
+// may share a key, which only makes their lists longer
+inline uint64_t
+cellKey(uint64_t x, uint64_t y, uint64_t z)
+{
+  auto h = x * 0x9e3779b97f4a7c15 ^ y * 0xc2b2ae3d27d4eb4f ^ z * 0x165667b19e3779f9;
+  return (h ^ h >> 29) | 1;
+}
+
+// Key of the cell of coincident points (-0 and 0 coincide)
+inline uint64_t
+pointKey(const vec3& p)
+{
+  return cellKey(std::bit_cast<uint32_t>(p.x + 0.0f),
+    std::bit_cast<uint32_t>(p.y + 0.0f),
+    std::bit_cast<uint32_t>(p.z + 0.0f));
+}
+
+// Grid coordinate of x in cells of size 1 / scale
+inline int64_t
+cellCoordinate(float x, double scale)
+{
+  constexpr auto max = double(int64_t{1} << 60);
+  auto c = std::floor(x * scale);
+
+  // Also maps NaN to 0
+  return !(c > -max) ? 0 : c < max ? int64_t(c) : int64_t(max);
+}
+
+//
+// CellTable: open addressing hash table of grid cells
+// =========
+// Each cell holds a list of vertices linked through an external next
+// array. Vertices are inserted by all threads at once; the order of
+// the lists depends on thread scheduling, so only order-independent
+// queries should walk them.
+//
+class CellTable
+{
+public:
+  CellTable(size_t count):
+    _mask{std::bit_ceil(2 * std::max<size_t>(count, 1)) - 1},
+    _keys(_mask + 1),
+    _heads(_mask + 1, none)
+  {
+    // do nothing
+  }
+
+  void insert(uint64_t key, index_t v, index_t* next)
+  {
+    for (auto i = slot(key);; i = (i + 1) & _mask)
+    {
+      std::atomic_ref<uint64_t> k{_keys[i]};
+      uint64_t current = 0;
+
+      if (k.compare_exchange_strong(current, key) || current == key)
+      {
+        next[v] = std::atomic_ref<index_t>{_heads[i]}.exchange(v);
+        return;
+      }
+    }
+  }
+
+  index_t head(uint64_t key) const
+  {
+    for (auto i = slot(key); _keys[i] != 0; i = (i + 1) & _mask)
+      if (_keys[i] == key)
+        return _heads[i];
+    return none;
+  }
+
+private:
+  size_t _mask;
+  std::vector<uint64_t> _keys;
+  std::vector<index_t> _heads;
+
+  size_t slot(uint64_t key) const
+  {
+    return (key ^ key >> 32) & _mask;
+  }
+
+}; // CellTable
+
+} // end namespace
+
+//
+// Every vertex is hashed into a grid of cells of size epsilon (or by its
+// coordinates, if epsilon is 0) and points to the least index of the
+// vertices within epsilon of it, found in its cell and the neighboring
+// cells. Following these links, which always decrease the index, gives
+// the vertex each vertex is merged into. The result does not depend on
+// the order of the lists, hence neither on the number of threads.
+//
+TriangleMesh::WeldResult
+TriangleMesh::weld(float epsilon)
+{
+  auto nv = _data._vertexSize;
+  auto nt = _data._triangleSize;
+  auto vertices = _data.vertices();
+  auto scale = epsilon > 0 ? 1.0 / epsilon : 0.0;
+  auto epsilon2 = epsilon * epsilon;
+  CellTable table{nv};
+  std::vector<index_t> next(nv);
+  std::vector<index_t> index(nv);
+
+  auto cell = [&](const vec3& p, int64_t c[3])
+  {
+    c[0] = cellCoordinate(p.x, scale);
+    c[1] = cellCoordinate(p.y, scale);
+    c[2] = cellCoordinate(p.z, scale);
+  };
+
+  parallelFor(nv, minVerticesPerSearch, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto v = index_t(b); v < e; ++v)
+    {
+      auto p = vertices[v];
+      int64_t c[3];
+
+      if (epsilon > 0)
+      {
+        cell(p, c);
+        table.insert(cellKey(c[0], c[1], c[2]), v, next.data());
+      }
+      else
+        table.insert(pointKey(p), v, next.data());
+    }
+  });
+  parallelFor(nv, minVerticesPerSearch, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto v = index_t(b); v < e; ++v)
+    {
+      auto p = vertices[v];
+      auto first = v;
+
+      if (epsilon > 0)
+      {
+        int64_t c[3];
+
+        cell(p, c);
+        for (int64_t x = c[0] - 1; x <= c[0] + 1; ++x)
+          for (int64_t y = c[1] - 1; y <= c[1] + 1; ++y)
+            for (int64_t z = c[2] - 1; z <= c[2] + 1; ++z)
+              for (auto u = table.head(cellKey(x, y, z)); u != none; u = next[u])
+                if (u < first)
+                {
+                  auto d = vertices[u] - p;
+
+                  if (d.x * d.x + d.y * d.y + d.z * d.z <= epsilon2)
+                    first = u;
+                }
+      }
+      else
+        for (auto u = table.head(pointKey(p)); u != none; u = next[u])
+        {
+          auto q = vertices[u];
+
+          if (u < first && q.x == p.x && q.y == p.y && q.z == p.z)
+            first = u;
+        }
+      index[v] = first;
+    }
+  });
+
+  // index[v] becomes the kept vertex v is merged into (index[v] <= v
+  // is final when v is reached) and next[v] the new index of a kept v
+  index_t vertexCount = 0;
+
+  for (index_t v = 0; v < nv; ++v)
+    if (index[v] == v)
+      next[v] = vertexCount++;
+    else
+      index[v] = index[index[v]];
+
+  // Each thread counts, then copies, the triangles of a block that are
+  // not degenerate after renumbering the vertices
+  auto m = blockCount(nt, minTrianglesPerBlock);
+  std::vector<index_t> offsets(m + 1);
+  auto renumber = [&](const Triangle& t)
+  {
+    return Triangle{next[index[t.i]], next[index[t.j]], next[index[t.k]]};
+  };
+  auto degenerate = [](const Triangle& t)
+  {
+    return t.i == t.j || t.j == t.k || t.k == t.i;
+  };
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned k)
+  {
+    index_t count = 0;
+
+    for (auto t = b; t < e; ++t)
+      count += !degenerate(renumber(_data._triangles[t]));
+    offsets[k + 1] = count;
+  });
+  for (unsigned k = 0; k < m; ++k)
+    offsets[k + 1] += offsets[k];
+
+  auto triangleCount = offsets[m];
+  auto vertexSize = (_data.hasVertexNormals() ? 2 : 1) * sizeof(vec3);
+  WeldResult result{nv - vertexCount, nt - triangleCount, 0};
+
+  result.bytes = result.vertices * vertexSize +
+    result.triangles * sizeof(Triangle);
+  if (result.bytes == 0)
+    return result;
+
+  auto triangles = Data::allocate<Triangle>(triangleCount);
+
+  parallelFor(nt, minTrianglesPerBlock, [&](size_t b, size_t e, unsigned k)
+  {
+    auto p = triangles + offsets[k];
+
+    for (auto t = b; t < e; ++t)
+      if (auto r = renumber(_data._triangles[t]); !degenerate(r))
+        *p++ = r;
+  });
+
+  std::vector<vec3> points(vertexCount);
+
+  parallelFor(nv, minVerticesPerBlock, [&](size_t b, size_t e, unsigned)
+  {
+    for (auto v = index_t(b); v < e; ++v)
+      if (index[v] == v)
+        points[next[v]] = vertices[v];
+  });
+
+  // The welded arrays are all allocated here; releasing the old ones
+  // drops the storage they may have lived in
+  auto hasNormals = _data.hasVertexNormals();
+
+  if (_data._layout == VertexLayout::SoA)
+  {
+    _data._vertexColumns.reallocate(vertexCount);
+    _data._normalColumns.reallocate(0);
+
+    auto columns = Data::columns(_data._vertexColumns);
+
+    for (index_t i = 0; i < vertexCount; ++i)
+      columns.ref(i) = points[i];
+  }
+  else
+  {
+    auto welded = Data::allocate<vec3>(vertexCount);
+
+    memcpy(welded, points.data(), vertexCount * sizeof(vec3));
+    _data.release(_data._vertices);
+    _data.release(_data._vertexNormals);
+    _data._vertices = welded;
+  }
+  _data.release(_data._triangles);
+  _data._triangles = triangles;
+  _data._vertexSize = vertexCount;
+  _data._triangleSize = triangleCount;
+  invalidateBounds();
+  invalidateAdjacency();
+  if (hasNormals)
+    computeVertexNormals();
+  return result;
+}
+
+} // end namespace tcii::cg